@@ -0,0 +1,470 @@
+/// bela header library benchmarks
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <benchmark/benchmark.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+#include <bela/base.hpp>
+#include <bela/command_template.hpp>
+#include <bela/escape_argv.hpp>
+#include <bela/path_buffer.hpp>
+#include <bela/path_fold.hpp>
+#include <bela/split_argv.hpp>
+
+namespace {
+
+// make_args returns count arguments of length characters, every fourth one needs quoting and escaping
+std::vector<std::wstring> make_args(size_t count, size_t length) {
+  std::vector<std::wstring> args;
+  args.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    std::wstring a(length, L'a' + static_cast<wchar_t>(i % 26));
+    if (i % 4 == 3 && length >= 8) {
+      a[length / 2] = L' ';
+      a[length / 4] = L'"';
+      a[length / 4 - 1] = L'\\';
+    }
+    args.emplace_back(std::move(a));
+  }
+  return args;
+}
+
+std::vector<std::wstring_view> make_views(const std::vector<std::wstring> &args) {
+  return std::vector<std::wstring_view>(args.begin(), args.end());
+}
+
+void escape_argv_args(benchmark::internal::Benchmark *b) {
+  for (auto count : {1, 16, 256}) {
+    for (auto length : {16, 256}) {
+      b->Args({count, length});
+    }
+  }
+}
+
+void BM_EscapeArgvAssign(benchmark::State &state) {
+  auto args = make_args(1, static_cast<size_t>(state.range(1)));
+  for (auto _ : state) {
+    bela::EscapeArgv ea;
+    ea.Assign(args[0]);
+    benchmark::DoNotOptimize(ea.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * args[0].size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_EscapeArgvAssign)->Args({1, 16})->Args({1, 256})->Args({1, 4096});
+
+void BM_EscapeArgvAppend(benchmark::State &state) {
+  auto args = make_args(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)));
+  for (auto _ : state) {
+    bela::EscapeArgv ea;
+    for (const auto &a : args) {
+      ea.Append(a);
+    }
+    benchmark::DoNotOptimize(ea.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * args.size()));
+}
+BENCHMARK(BM_EscapeArgvAppend)->Apply(escape_argv_args);
+
+void BM_EscapeArgvAssignFull(benchmark::State &state) {
+  auto args = make_args(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)));
+  auto views = make_views(args);
+  for (auto _ : state) {
+    bela::EscapeArgv ea;
+    ea.AssignFull(views);
+    benchmark::DoNotOptimize(ea.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * args.size()));
+}
+BENCHMARK(BM_EscapeArgvAssignFull)->Apply(escape_argv_args);
+
+// the same arguments streamed by basic_argv_writer, against BM_EscapeArgvAppend: into a string reserved to the exact
+// size, into a caller buffer through a span sink, and into the 1024 character stack buffer invoke.cc renders into
+void BM_ArgvWriterString(benchmark::State &state) {
+  auto args = make_args(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)));
+  auto views = make_views(args);
+  for (auto _ : state) {
+    std::wstring line;
+    line.reserve(bela::EscapeArgv::EscapedSize(views));
+    bela::basic_string_sink<wchar_t> sink(line);
+    bela::basic_argv_writer<wchar_t, decltype(sink)> writer(sink);
+    for (auto v : views) {
+      writer.Append(v);
+    }
+    benchmark::DoNotOptimize(line.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * args.size()));
+}
+BENCHMARK(BM_ArgvWriterString)->Apply(escape_argv_args);
+
+void BM_ArgvWriterSpan(benchmark::State &state) {
+  auto args = make_args(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)));
+  auto views = make_views(args);
+  std::vector<wchar_t> buffer(bela::EscapeArgv::EscapedSize(views));
+  for (auto _ : state) {
+    bela::basic_span_sink<wchar_t> sink(buffer);
+    bela::basic_argv_writer<wchar_t, decltype(sink)> writer(sink);
+    for (auto v : views) {
+      writer.Append(v);
+    }
+    benchmark::DoNotOptimize(sink.sv().data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * args.size()));
+}
+BENCHMARK(BM_ArgvWriterSpan)->Apply(escape_argv_args);
+
+void BM_ArgvWriterFixed(benchmark::State &state) {
+  auto args = make_args(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)));
+  for (auto _ : state) {
+    bela::basic_fixed_buffer_sink<wchar_t, 1024> sink;
+    bela::basic_argv_writer<wchar_t, decltype(sink)> writer(sink);
+    for (const auto &a : args) {
+      writer.Append(a);
+    }
+    benchmark::DoNotOptimize(sink.c_str());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * args.size()));
+}
+BENCHMARK(BM_ArgvWriterFixed)->Args({1, 16})->Args({1, 256})->Args({16, 16});
+
+// the git-bash.exe command line: the constant arguments scanned at runtime and --cd= concatenated with the location
+// first, against the literals escaped at compile time and the location joined to the pre-escaped prefix
+constexpr std::wstring_view git_bash = LR"(C:\Program Files\Git\git-bash.exe)";
+constexpr std::wstring_view git_location = LR"(C:\Users\dev\source\repos\my project)";
+
+void BM_EscapeArgvRuntimeConstants(benchmark::State &state) {
+  for (auto _ : state) {
+    bela::EscapeArgv ea;
+    std::wstring cd(L"--cd=");
+    cd.append(git_location);
+    ea.Append(git_bash).Append(L"--no-cd").Append(L"--reuse-window").Append(cd);
+    benchmark::DoNotOptimize(ea.data());
+  }
+}
+BENCHMARK(BM_EscapeArgvRuntimeConstants);
+
+void BM_EscapeArgvLiterals(benchmark::State &state) {
+  constexpr auto noCd = bela::escape_literal<L"--no-cd">();
+  constexpr auto reuse = bela::escape_literal<L"--reuse-window">();
+  for (auto _ : state) {
+    bela::EscapeArgv ea;
+    ea.Append(git_bash).Append(noCd).Append(reuse).AppendJoined<bela::escape_literal<L"--cd=">()>(git_location);
+    benchmark::DoNotOptimize(ea.data());
+  }
+}
+BENCHMARK(BM_EscapeArgvLiterals);
+
+// classify and find_quote of one argument of range(0) characters, a quote near its end, scalar against SSE2/AVX2
+std::wstring make_scan_arg(size_t length) {
+  auto arg = make_args(4, length).back();
+  if (length >= 8) {
+    arg[length - 2] = L'"';
+  }
+  return arg;
+}
+
+void BM_ClassifyScalar(benchmark::State &state) {
+  auto arg = make_scan_arg(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto ec = bela::argv_internal::classify_scalar(arg.data(), arg.size());
+    benchmark::DoNotOptimize(ec);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * arg.size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_ClassifyScalar)->Arg(16)->Arg(256)->Arg(4096);
+
+void BM_FindQuoteScalar(benchmark::State &state) {
+  auto arg = make_scan_arg(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto pos = bela::argv_internal::find_quote_scalar(arg.data(), arg.size());
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * arg.size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_FindQuoteScalar)->Arg(16)->Arg(256)->Arg(4096);
+
+#if defined(BELA_ESCAPE_ARGV_AVX2) || defined(BELA_ESCAPE_ARGV_SSE2)
+void BM_ClassifySimd(benchmark::State &state) {
+  auto arg = make_scan_arg(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto ec = bela::argv_internal::classify_simd(arg.data(), arg.size());
+    benchmark::DoNotOptimize(ec);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * arg.size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_ClassifySimd)->Arg(16)->Arg(256)->Arg(4096);
+
+void BM_FindQuoteSimd(benchmark::State &state) {
+  auto arg = make_scan_arg(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto pos = bela::argv_internal::find_quote_simd(arg.data(), arg.size());
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * arg.size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_FindQuoteSimd)->Arg(16)->Arg(256)->Arg(4096);
+#endif
+
+// splitting a command line of range(0) arguments of range(1) characters, every fourth one escaped. BM_SplitArgv only
+// walks the tokens, BM_SplitArgvCopy also copies every argument out like CommandLineToArgvW does.
+std::wstring make_command_line(benchmark::State &state) {
+  auto args = make_args(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)));
+  bela::EscapeArgv ea;
+  ea.Append(L"code.exe");
+  for (const auto &a : args) {
+    ea.Append(a);
+  }
+  return std::wstring(ea.sv());
+}
+
+void BM_SplitArgv(benchmark::State &state) {
+  auto cmdline = make_command_line(state);
+  for (auto _ : state) {
+    bela::argv_splitter splitter(cmdline);
+    bela::argv_token token;
+    size_t n = 0;
+    while (splitter.Next(token)) {
+      benchmark::DoNotOptimize(token.raw.data());
+      n++;
+    }
+    benchmark::DoNotOptimize(n);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * cmdline.size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_SplitArgv)->Args({16, 16})->Args({2000, 64});
+
+void BM_SplitArgvCopy(benchmark::State &state) {
+  auto cmdline = make_command_line(state);
+  for (auto _ : state) {
+    std::vector<std::wstring> args;
+    bela::argv_splitter splitter(cmdline);
+    bela::argv_token token;
+    while (splitter.Next(token)) {
+      args.emplace_back(token.str());
+    }
+    benchmark::DoNotOptimize(args.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * cmdline.size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_SplitArgvCopy)->Args({16, 16})->Args({2000, 64});
+
+// a command line per selected item, range(0) items: the template copied and "%1" replaced for every item as Invoke
+// did, against the compiled template rendered into one reused string
+constexpr std::wstring_view code_template = LR"("C:\Users\dev\AppData\Local\Programs\Microsoft VS Code\Code.exe" "%1")";
+
+std::vector<std::wstring> make_items(size_t count) {
+  std::vector<std::wstring> items;
+  items.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    items.emplace_back(LR"(C:\Users\dev\source\repos\my project\src\file)" + std::to_wstring(i) + L".cc");
+  }
+  return items;
+}
+
+void BM_RenderReplacePerItem(benchmark::State &state) {
+  auto items = make_items(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    for (const auto &item : items) {
+      std::wstring cmdline(code_template);
+      cmdline.replace(cmdline.find(L"%1"), 2, item);
+      benchmark::DoNotOptimize(cmdline.data());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items.size()));
+}
+BENCHMARK(BM_RenderReplacePerItem)->Arg(1)->Arg(16)->Arg(256);
+
+void BM_RenderTemplate(benchmark::State &state) {
+  auto items = make_items(static_cast<size_t>(state.range(0)));
+  bela::command_template t;
+  t.Compile(code_template);
+  std::wstring cmdline;
+  for (auto _ : state) {
+    for (const auto &item : items) {
+      t.Render({item, LR"(C:\Users\dev\source\repos\my project\src)", {}}, cmdline);
+      benchmark::DoNotOptimize(cmdline.data());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items.size()));
+}
+BENCHMARK(BM_RenderTemplate)->Arg(1)->Arg(16)->Arg(256);
+
+// joining base/libexec/<name> for 16 names and probing them, half exist: std::filesystem::path against path_buffer
+using native_path_buffer = bela::basic_path_buffer<std::filesystem::path::value_type, bela::path_internal::max_path>;
+
+struct join_fixture {
+  join_fixture() {
+    base = std::filesystem::temp_directory_path() / "bela-bench-join";
+    std::filesystem::create_directories(base / "libexec");
+    for (int i = 0; i < 16; i++) {
+      auto name = std::filesystem::path("tool" + std::to_string(i) + ".exe");
+      names.emplace_back(name.native());
+      if (i % 2 == 0) {
+        std::ofstream(base / "libexec" / name).put('x');
+      }
+    }
+  }
+  std::filesystem::path base;
+  std::vector<std::filesystem::path::string_type> names;
+};
+
+bool native_exists(const std::filesystem::path::value_type *path) {
+#if defined(_WIN32)
+  return GetFileAttributesW(path) != INVALID_FILE_ATTRIBUTES;
+#else
+  struct stat st;
+  return ::stat(path, &st) == 0;
+#endif
+}
+
+void BM_JoinFilesystemPath(benchmark::State &state) {
+  join_fixture fx;
+  auto probe = state.range(0) != 0;
+  for (auto _ : state) {
+    size_t found = 0;
+    for (const auto &name : fx.names) {
+      auto p = fx.base / "libexec" / name;
+      if (probe ? std::filesystem::exists(p) : !p.empty()) {
+        found++;
+      }
+    }
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * fx.names.size()));
+}
+BENCHMARK(BM_JoinFilesystemPath)->ArgName("exists")->Arg(0)->Arg(1);
+
+void BM_JoinPathBuffer(benchmark::State &state) {
+  join_fixture fx;
+  auto probe = state.range(0) != 0;
+  for (auto _ : state) {
+    size_t found = 0;
+    native_path_buffer p(fx.base.native());
+    p.Join(std::filesystem::path("libexec").native());
+    auto prefix = p.size();
+    for (const auto &name : fx.names) {
+      p.Truncate(prefix);
+      p.Join(name);
+      if (probe ? native_exists(p.c_str()) : !p.empty()) {
+        found++;
+      }
+    }
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * fx.names.size()));
+}
+BENCHMARK(BM_JoinPathBuffer)->ArgName("exists")->Arg(0)->Arg(1);
+
+// hashing and comparing an ASCII path of range(0) characters case-insensitively, scalar against SSE2/AVX2
+std::wstring make_fold_path(size_t length) {
+  std::wstring s(L"C:\\Users\\Dev\\Source\\Repos\\");
+  while (s.size() < length) {
+    s.append(L"Project\\");
+  }
+  s.resize(length);
+  return s;
+}
+
+void BM_HashFoldScalar(benchmark::State &state) {
+  auto path = make_fold_path(static_cast<size_t>(state.range(0)));
+  namespace fi = bela::fold_internal;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fi::finish(fi::hash_scalar(fi::seed, path.data(), path.size()), path.size()));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * path.size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_HashFoldScalar)->Arg(32)->Arg(128)->Arg(1024);
+
+void BM_EqualFoldScalar(benchmark::State &state) {
+  auto path = make_fold_path(static_cast<size_t>(state.range(0)));
+  auto upper = bela::fold_case(std::wstring_view(path));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bela::fold_internal::equal_scalar(path.data(), upper.data(), path.size()));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * path.size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_EqualFoldScalar)->Arg(32)->Arg(128)->Arg(1024);
+
+#if defined(BELA_PATH_FOLD_AVX2) || defined(BELA_PATH_FOLD_SSE2)
+void BM_HashFoldSimd(benchmark::State &state) {
+  auto path = make_fold_path(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bela::hash_fold(std::wstring_view(path)));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * path.size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_HashFoldSimd)->Arg(32)->Arg(128)->Arg(1024);
+
+void BM_EqualFoldSimd(benchmark::State &state) {
+  auto path = make_fold_path(static_cast<size_t>(state.range(0)));
+  auto upper = bela::fold_case(std::wstring_view(path));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bela::equal_fold(std::wstring_view(path), upper));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * path.size() * sizeof(wchar_t)));
+}
+BENCHMARK(BM_EqualFoldSimd)->Arg(32)->Arg(128)->Arg(1024);
+#endif
+
+void BM_ErrorCodeConstruct(benchmark::State &state) {
+  std::wstring_view message = L"unable to open the GitForWindows key";
+  for (auto _ : state) {
+    bela::error_code ec(message, bela::ErrGeneral);
+    benchmark::DoNotOptimize(ec);
+  }
+}
+BENCHMARK(BM_ErrorCodeConstruct);
+
+void BM_ErrorCodeMove(benchmark::State &state) {
+  bela::error_code ec(std::wstring_view(L"unable to open the GitForWindows key"), bela::ErrGeneral);
+  for (auto _ : state) {
+    auto other = std::move(ec);
+    benchmark::DoNotOptimize(other);
+    ec = std::move(other);
+  }
+}
+BENCHMARK(BM_ErrorCodeMove);
+
+// the failure path of a probe: the code is recorded, nobody reads the message
+void BM_ErrorCodeFromSystem(benchmark::State &state) {
+  for (auto _ : state) {
+    auto ec = bela::make_error_code_from_system(2, L"open ");
+    benchmark::DoNotOptimize(ec);
+  }
+}
+BENCHMARK(BM_ErrorCodeFromSystem);
+
+void BM_ErrorCodeFromSystemMessage(benchmark::State &state) {
+  for (auto _ : state) {
+    auto ec = bela::make_error_code_from_system(2, L"open ");
+    benchmark::DoNotOptimize(ec.message().data());
+  }
+}
+BENCHMARK(BM_ErrorCodeFromSystemMessage);
+
+void BM_Finally(benchmark::State &state) {
+  int calls = 0;
+  for (auto _ : state) {
+    auto closer = bela::finally([&] { calls++; });
+    benchmark::DoNotOptimize(calls);
+  }
+  benchmark::DoNotOptimize(calls);
+}
+BENCHMARK(BM_Finally);
+
+// BM_FinallyBaseline is the same loop without finally, the difference is its overhead
+void BM_FinallyBaseline(benchmark::State &state) {
+  int calls = 0;
+  for (auto _ : state) {
+    calls++;
+    benchmark::DoNotOptimize(calls);
+  }
+}
+BENCHMARK(BM_FinallyBaseline);
+
+} // namespace
@@ -0,0 +1,26 @@
+/// benchmark entry point, JSON output by default so results can be compared across releases
+#include <string_view>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+int main(int argc, char **argv) {
+  std::vector<char *> args(argv, argv + argc);
+  static char json[] = "--benchmark_format=json";
+  bool format = false;
+  for (int i = 1; i < argc; i++) {
+    if (std::string_view(argv[i]).starts_with("--benchmark_format")) {
+      format = true;
+    }
+  }
+  if (!format) {
+    args.insert(args.begin() + 1, json);
+  }
+  auto n = static_cast<int>(args.size());
+  benchmark::Initialize(&n, args.data());
+  if (benchmark::ReportUnrecognizedArguments(n, args.data())) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
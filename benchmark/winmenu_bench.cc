@@ -0,0 +1,340 @@
+/// WinMenu core benchmarks over the fakes of the unit tests
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <bela/escape_argv.hpp>
+#include <winmenu/argv_packer.hpp>
+#include <winmenu/code_config.hpp>
+#include <winmenu/path_interner.hpp>
+#include <winmenu/scratch_arena.hpp>
+#include <winmenu/selection.hpp>
+#include <winmenu/storage_pool.hpp>
+#include <winmenu/verb_state.hpp>
+#include <winmenu/verb_table.hpp>
+#include "fakes.hpp"
+
+namespace {
+
+winmenu::fake_item_list make_selection(size_t count) {
+  winmenu::fake_item_list items;
+  items.items.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    auto path = LR"(C:\Users\dev\source\repos\project\)" + std::to_wstring(i);
+    if (i % 8 == 0) {
+      items.add_directory(path);
+    } else {
+      items.add_file(path);
+    }
+  }
+  return items;
+}
+
+// classify_selection asks for the attributes of every item in one call
+void BM_ClassifySelection(benchmark::State &state) {
+  auto items = make_selection(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto facts = winmenu::classify_selection(items);
+    benchmark::DoNotOptimize(facts);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items.items.size()));
+}
+BENCHMARK(BM_ClassifySelection)->Arg(1)->Arg(100)->Arg(10000);
+
+// every verb of a menu asks again, the classifier answers from the first classification
+void BM_ClassifierRepeated(benchmark::State &state) {
+  auto items = make_selection(static_cast<size_t>(state.range(0)));
+  winmenu::selection_classifier classifier;
+  for (auto _ : state) {
+    auto facts = classifier.classify(&items, items);
+    benchmark::DoNotOptimize(facts);
+  }
+}
+BENCHMARK(BM_ClassifierRepeated)->Arg(10000);
+
+// com_item_list hands out paths like the Windows adapters: every GetDisplayName returns a fresh CoTaskMem buffer that
+// path copies into a string and copy_path into the arena, both release it right after
+class com_item_list final : public winmenu::shell_item_list {
+public:
+  explicit com_item_list(winmenu::fake_item_list &items_) : items(items_) {}
+  size_t count() override { return items.count(); }
+  bool path(size_t index, std::wstring &out) override {
+    auto name = display_name(index);
+    out.assign(name.get());
+    return true;
+  }
+  bool copy_path(size_t index, winmenu::scratch_arena &arena, std::wstring_view &out) override {
+    auto name = display_name(index);
+    out = arena.copy(name.get());
+    return true;
+  }
+  bool attributes(uint32_t mask, uint32_t &all, uint32_t &any) override { return items.attributes(mask, all, any); }
+
+private:
+  std::unique_ptr<wchar_t[]> display_name(size_t index) {
+    const auto &p = items.items[index].path;
+    auto name = std::make_unique<wchar_t[]>(p.size() + 1);
+    std::copy_n(p.c_str(), p.size() + 1, name.get());
+    benchmark::DoNotOptimize(name.get());
+    return name;
+  }
+  winmenu::fake_item_list &items;
+};
+
+// collecting the paths of a selection as invoke_code did before the arena: a string per path, views over them after
+void BM_CollectPathsHeap(benchmark::State &state) {
+  auto items = make_selection(static_cast<size_t>(state.range(0)));
+  com_item_list com(items);
+  for (auto _ : state) {
+    auto count = com.count();
+    std::vector<std::wstring> paths;
+    paths.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      std::wstring path;
+      if (com.path(i, path)) {
+        paths.emplace_back(std::move(path));
+      }
+    }
+    std::vector<std::wstring_view> views(paths.begin(), paths.end());
+    benchmark::DoNotOptimize(views.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items.items.size()));
+}
+BENCHMARK(BM_CollectPathsHeap)->Arg(1)->Arg(100)->Arg(10000);
+
+// the same through the scratch arena of invoke_code
+void BM_CollectPathsArena(benchmark::State &state) {
+  auto items = make_selection(static_cast<size_t>(state.range(0)));
+  com_item_list com(items);
+  for (auto _ : state) {
+    winmenu::scratch_arena arena;
+    auto count = com.count();
+    std::pmr::vector<std::wstring_view> views(arena.resource());
+    views.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      std::wstring_view path;
+      if (com.copy_path(i, arena, path)) {
+        views.emplace_back(path);
+      }
+    }
+    benchmark::DoNotOptimize(views.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items.items.size()));
+}
+BENCHMARK(BM_CollectPathsArena)->Arg(1)->Arg(100)->Arg(10000);
+
+// make_paths returns count selection paths with a blank, every one of them is quoted
+std::vector<std::wstring> make_paths(size_t count) {
+  std::vector<std::wstring> paths;
+  paths.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    paths.emplace_back(LR"(C:\Users\dev\source\repos\my project\src\file)" + std::to_wstring(i) + L".cc");
+  }
+  return paths;
+}
+
+// packing as it was before argv_packer: every path escaped into a scratch string, then copied into a line reserved at
+// the CreateProcess limit
+void BM_PackArgvTwoCopies(benchmark::State &state) {
+  auto paths = make_paths(static_cast<size_t>(state.range(0)));
+  constexpr std::wstring_view prefix = LR"("C:\Program Files\Microsoft VS Code\Code.exe")";
+  for (auto _ : state) {
+    std::vector<std::wstring> lines;
+    std::wstring line;
+    for (const auto &p : paths) {
+      bela::EscapeArgv ea;
+      ea.Assign(p);
+      if (line.empty() || line.size() + 1 + ea.size() > winmenu::command_line_limit - 1) {
+        if (!line.empty()) {
+          lines.emplace_back(std::move(line));
+        }
+        line.clear();
+        line.reserve(winmenu::command_line_limit);
+        line.assign(prefix);
+      }
+      line.push_back(L' ');
+      line.append(ea.sv());
+    }
+    lines.emplace_back(std::move(line));
+    benchmark::DoNotOptimize(lines.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * paths.size()));
+}
+BENCHMARK(BM_PackArgvTwoCopies)->Arg(1)->Arg(1000)->Arg(50000);
+
+// argv_packer escapes every path once, straight into a command line of the exact size
+void BM_PackArgv(benchmark::State &state) {
+  auto paths = make_paths(static_cast<size_t>(state.range(0)));
+  winmenu::argv_packer packer(LR"("C:\Program Files\Microsoft VS Code\Code.exe")", {});
+  for (auto _ : state) {
+    packer.Reserve(paths.size());
+    for (const auto &p : paths) {
+      packer.Append(p);
+    }
+    auto lines = packer.Finish();
+    benchmark::DoNotOptimize(lines.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * paths.size()));
+}
+BENCHMARK(BM_PackArgv)->Arg(1)->Arg(1000)->Arg(50000);
+
+// opening the WinMenu submenu the way shellext.cc serves it: EnumSubCommands creates an enumerator, Next one command
+// per child, and Explorer releases them all when the menu closes. The pooled objects take their storage from
+// storage_pools sized like SubCommands and VerbCommand; the eager ones are built up front with the heap each time.
+// heap_per_open is the number of blocks taken from the heap per open, it stays at zero once the pools are warm.
+struct submenu_child {
+  const winmenu::verb_descriptor *verb{nullptr};
+  winmenu::selection_classifier classifier;
+  winmenu::verb_state_machine state;
+};
+
+struct pooled_command : submenu_child {
+  static void *operator new(size_t) noexcept { return pool().allocate(); }
+  static void operator delete(void *p) noexcept { pool().deallocate(p); }
+  static winmenu::storage_pool<pooled_command, 16> &pool() {
+    static winmenu::storage_pool<pooled_command, 16> p;
+    return p;
+  }
+};
+
+struct pooled_enumerator {
+  explicit pooled_enumerator(const winmenu::verb_descriptor &menu) : cursor(menu) {}
+  // next materializes the children Explorer asks for
+  size_t next(std::span<pooled_command *> out) {
+    size_t n = 0;
+    const winmenu::verb_descriptor *child = nullptr;
+    for (; n < out.size() && cursor.next({&child, 1}) == 1; n++) {
+      out[n] = new pooled_command;
+      out[n]->verb = child;
+    }
+    return n;
+  }
+  static void *operator new(size_t) noexcept { return pool().allocate(); }
+  static void operator delete(void *p) noexcept { pool().deallocate(p); }
+  static winmenu::storage_pool<pooled_enumerator, 4> &pool() {
+    static winmenu::storage_pool<pooled_enumerator, 4> p;
+    return p;
+  }
+  winmenu::submenu_cursor cursor;
+};
+
+const winmenu::verb_descriptor &winmenu_submenu() {
+  return *std::find_if(std::begin(winmenu::verb_table), std::end(winmenu::verb_table),
+                       [](const auto &v) { return v.submenu(); });
+}
+
+void BM_SubmenuOpenPooled(benchmark::State &state) {
+  const auto &menu = winmenu_submenu();
+  auto heap = [] { return pooled_enumerator::pool().snapshot().heap + pooled_command::pool().snapshot().heap; };
+  auto before = heap();
+  std::array<pooled_command *, 8> children{};
+  for (auto _ : state) {
+    auto e = new pooled_enumerator(menu);
+    auto n = e->next(children);
+    benchmark::DoNotOptimize(children.data());
+    for (size_t i = 0; i < n; i++) {
+      delete children[i];
+    }
+    delete e;
+  }
+  state.counters["heap_per_open"] =
+      benchmark::Counter(static_cast<double>(heap() - before), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SubmenuOpenPooled);
+
+void BM_SubmenuOpenEager(benchmark::State &state) {
+  const auto &menu = winmenu_submenu();
+  uint64_t heap = 0;
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<submenu_child>> children;
+    children.reserve(menu.children.size());
+    heap++;
+    for (auto i : menu.children) {
+      children.emplace_back(std::make_unique<submenu_child>())->verb = &winmenu::verb_table[i];
+      heap++;
+    }
+    benchmark::DoNotOptimize(children.data());
+  }
+  state.counters["heap_per_open"] = benchmark::Counter(static_cast<double>(heap), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SubmenuOpenEager);
+
+// interning a stream of paths where one in range(0) is new, through a table of 1024 entries that sweeps itself
+void BM_InternChurn(benchmark::State &state) {
+  auto every = static_cast<size_t>(state.range(0));
+  std::vector<std::wstring> hot;
+  for (size_t i = 0; i < 256; i++) {
+    hot.emplace_back(LR"(C:\Users\dev\source\repos\project\)" + std::to_wstring(i));
+  }
+  winmenu::path_interner interner(1024);
+  std::vector<winmenu::interned_path> held;
+  for (const auto &p : hot) {
+    held.emplace_back(interner.intern(p));
+  }
+  size_t i = 0;
+  std::wstring fresh;
+  for (auto _ : state) {
+    if (every != 0 && i % every == 0) {
+      fresh.assign(LR"(C:\Users\dev\Downloads\)").append(std::to_wstring(i));
+      benchmark::DoNotOptimize(interner.intern(fresh));
+    } else {
+      benchmark::DoNotOptimize(interner.intern(hot[i % hot.size()]));
+    }
+    i++;
+  }
+  auto st = interner.snapshot();
+  state.counters["reclaimed"] = static_cast<double>(st.reclaimed);
+}
+BENCHMARK(BM_InternChurn)->ArgName("new_every")->Arg(0)->Arg(4)->Arg(1);
+
+// code_config_watcher that either keeps a watch that never fires or refuses like a registry without notifications
+class bench_code_watcher final : public winmenu::code_config_watcher {
+public:
+  explicit bench_code_watcher(bool watchable_) : watchable(watchable_) {}
+  bool watch(std::function<void()>) override { return watchable; }
+
+private:
+  bool watchable;
+};
+
+void install_code(winmenu::fake_config_source &source) {
+  source.set(winmenu::code_command_key, L"", LR"("C:\Program Files\Microsoft VS Code\Code.exe" "%1")");
+  source.set(winmenu::code_shell_key, L"Icon", LR"(C:\Program Files\Microsoft VS Code\Code.exe)");
+}
+
+// resolving the VS Code verb on every menu open, what code_config_cache saves
+void BM_CodeConfigResolve(benchmark::State &state) {
+  winmenu::fake_config_source source;
+  install_code(source);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(winmenu::resolve_code_config(source));
+  }
+  state.counters["reads_per_get"] =
+      benchmark::Counter(static_cast<double>(source.read_count()), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_CodeConfigResolve);
+
+// code_config_cache with the key watched, or unwatched with a time to live of range(0) ms; with 0 every get
+// resolves and tries to watch again
+void BM_CodeConfigCache(benchmark::State &state, bool watchable) {
+  winmenu::fake_config_source source;
+  install_code(source);
+  bench_code_watcher watcher(watchable);
+  auto ttl = std::chrono::milliseconds(state.range(0));
+  winmenu::code_config_cache cache(source, watcher, ttl, ttl);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.get());
+  }
+  state.counters["reads_per_get"] =
+      benchmark::Counter(static_cast<double>(source.read_count()), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_CAPTURE(BM_CodeConfigCache, watched, true)->ArgName("ttl_ms")->Arg(0);
+BENCHMARK_CAPTURE(BM_CodeConfigCache, unwatched, false)->ArgName("ttl_ms")->Arg(0)->Arg(60000);
+
+} // namespace
@@ -0,0 +1,90 @@
+///
+#include <algorithm>
+#include <bela/path_buffer.hpp>
+#include <bela/split_argv.hpp>
+#include <winmenu/code_config.hpp>
+#include <winmenu/git_install.hpp>
+
+namespace winmenu {
+
+namespace {
+// expand_environment replaces %NAME% references like ExpandEnvironmentStringsW, an undefined or empty name is kept as
+// is and its closing % may open the next reference
+std::wstring expand_environment(std::wstring_view text, config_source &source) {
+  std::wstring out;
+  out.reserve(text.size());
+  size_t i = 0;
+  while (i < text.size()) {
+    auto pos = text.find(L'%', i);
+    auto end = pos == std::wstring_view::npos ? pos : text.find(L'%', pos + 1);
+    if (end == std::wstring_view::npos) {
+      out.append(text.substr(i));
+      break;
+    }
+    out.append(text.substr(i, pos - i));
+    auto name = text.substr(pos + 1, end - pos - 1);
+    if (auto value = name.empty() ? std::nullopt : source.environment(name); value) {
+      out.append(*value);
+      i = end + 1;
+      continue;
+    }
+    out.append(text.substr(pos, end - pos));
+    i = end;
+  }
+  return out;
+}
+} // namespace
+
+std::optional<code_config> resolve_code_config(config_source &source) {
+  auto command = source.read_string(code_command_key, L"");
+  if (!command || command->empty()) {
+    return std::nullopt;
+  }
+  // a command that does not name a program, such as "" "%1", cannot be launched
+  std::wstring_view commandLine(*command);
+  commandLine.remove_prefix(std::min(commandLine.find_first_not_of(L" \t"), commandLine.size()));
+  bela::argv_splitter splitter(commandLine);
+  if (bela::argv_token program; !splitter.Next(program) || program.value.empty()) {
+    return std::nullopt;
+  }
+  auto resolver = [&](std::wstring_view name, std::wstring &value) {
+    auto v = source.environment(name);
+    if (!v) {
+      return false;
+    }
+    value.append(*v);
+    return true;
+  };
+  code_config cfg;
+  cfg.command.Compile(*command, resolver);
+  // the icon is a resource path, not a command: only environment references are expanded
+  if (auto icon = source.read_string(code_shell_key, L"Icon"); icon) {
+    cfg.icon = process_interner().intern(expand_environment(*icon, source));
+  }
+  return std::make_optional(std::move(cfg));
+}
+
+std::optional<git_install> resolve_git_install(git_install_backend &backend, filesystem_probe &fs) {
+  auto installPath = backend.install_path();
+  if (!installPath || installPath->empty()) {
+    return std::nullopt;
+  }
+  git_install gi;
+  // both executables are joined in one buffer over the install path, only what exists is copied out. The path is a
+  // Windows path wherever the core runs.
+  bela::windows_path_buffer path(*installPath);
+  auto base = path.size();
+  if (!fs.exists(path.Join(L"git-bash.exe"))) {
+    return std::nullopt;
+  }
+  auto &interner = process_interner();
+  gi.git_bash = interner.intern(path);
+  path.Truncate(base);
+  if (fs.exists(path.Join(LR"(cmd\git-gui.exe)"))) {
+    gi.git_gui = interner.intern(path);
+  }
+  gi.install_path = interner.intern(*installPath);
+  return std::make_optional(std::move(gi));
+}
+
+} // namespace winmenu
@@ -0,0 +1,112 @@
+///
+#include <vector>
+#include <memory_resource>
+#include <winmenu/invoke.hpp>
+#include <winmenu/argv_packer.hpp>
+#include <winmenu/scratch_arena.hpp>
+#include <winmenu/trace.hpp>
+
+namespace winmenu {
+
+namespace {
+// render_command_line builds a command line with build(writer) in a buffer on the stack and stores it in out with a
+// single allocation of the exact size. A command line that does not fit is built again straight into out, reserved to
+// the size the first pass measured.
+template <typename Build> void render_command_line(Build &&build, std::wstring &out) {
+  bela::basic_fixed_buffer_sink<wchar_t, 1024> stack;
+  {
+    bela::basic_argv_writer<wchar_t, decltype(stack)> writer(stack);
+    build(writer);
+  }
+  if (!stack.overflow()) {
+    out.assign(stack.sv());
+    return;
+  }
+  out.clear();
+  out.reserve(stack.size());
+  bela::basic_string_sink<wchar_t> sink(out);
+  bela::basic_argv_writer<wchar_t, decltype(sink)> writer(sink);
+  build(writer);
+}
+} // namespace
+
+std::wstring_view parent_directory(std::wstring_view path) {
+  auto pos = path.find_last_of(L"\\/");
+  if (pos == std::wstring_view::npos) {
+    return {};
+  }
+  if (pos == 2 && path[1] == L':') {
+    return path.substr(0, 3);
+  }
+  return path.substr(0, pos);
+}
+
+size_t invoke_code(const code_config &cfg, shell_item_list &items, process_launcher &launcher, bool batch) {
+  // paths only live until the last command line is rendered, the arena frees them together
+  scratch_arena arena;
+  auto count = items.count();
+  std::pmr::vector<std::wstring_view> views(arena.resource());
+  views.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    std::wstring_view path;
+    if (items.copy_path(i, arena, path)) {
+      views.emplace_back(path);
+    }
+  }
+  size_t launched = 0;
+  launch_request request;
+  if (batch && views.size() > 1) {
+    std::wstring prefix;
+    std::wstring suffix;
+    if (cfg.command.RenderParts({{}, parent_directory(views.front()), views}, prefix, suffix)) {
+      argv_packer packer(prefix, suffix);
+      packer.Reserve(views.size());
+      for (auto v : views) {
+        packer.Append(v);
+      }
+      for (auto &cmdline : packer.Finish()) {
+        request.command_line = std::move(cmdline);
+        process_tracer().count(trace_counter::command_line_bytes, request.command_line.size() * sizeof(wchar_t));
+        if (launcher.launch(request)) {
+          launched++;
+        }
+      }
+      return launched;
+    }
+  }
+  for (const auto &v : views) {
+    cfg.command.Render({v, parent_directory(v), {&v, 1}}, request.command_line);
+    process_tracer().count(trace_counter::command_line_bytes, request.command_line.size() * sizeof(wchar_t));
+    if (launcher.launch(request)) {
+      launched++;
+    }
+  }
+  return launched;
+}
+
+bool invoke_git_bash(const git_install &gi, std::wstring_view directory, process_launcher &launcher) {
+  launch_request request;
+  render_command_line(
+      [&](auto &writer) {
+        writer.Append(gi.git_bash).template AppendJoined<bela::escape_literal<L"--cd=">()>(directory);
+      },
+      request.command_line);
+  request.application = gi.git_bash;
+  request.directory = directory;
+  process_tracer().count(trace_counter::command_line_bytes, request.command_line.size() * sizeof(wchar_t));
+  return launcher.launch(request);
+}
+
+bool invoke_git_gui(const git_install &gi, std::wstring_view directory, process_launcher &launcher) {
+  if (gi.git_gui.empty()) {
+    return false;
+  }
+  launch_request request;
+  render_command_line([&](auto &writer) { writer.Append(gi.git_gui); }, request.command_line);
+  request.application = gi.git_gui;
+  request.directory = directory;
+  process_tracer().count(trace_counter::command_line_bytes, request.command_line.size() * sizeof(wchar_t));
+  return launcher.launch(request);
+}
+
+} // namespace winmenu
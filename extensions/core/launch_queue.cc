@@ -0,0 +1,100 @@
+///
+#include <algorithm>
+#include <system_error>
+#include <thread>
+#include <winmenu/launch_queue.hpp>
+#include <winmenu/trace.hpp>
+
+namespace winmenu {
+
+namespace {
+bool detached_thread(launch_queue::work w) {
+  try {
+    std::thread(std::move(w)).detach();
+  } catch (const std::system_error &) {
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+launch_queue::launch_queue(std::shared_ptr<process_launcher> inner, failure_handler onFailure, executor exec_)
+    : st(std::make_shared<state>()), exec(std::move(exec_)) {
+  st->inner = std::move(inner);
+  st->onFailure = std::move(onFailure);
+  if (!exec) {
+    exec = detached_thread;
+  }
+}
+
+bool launch_queue::launch(launch_request &request) {
+  {
+    std::lock_guard lock(st->mu);
+    if ((st->inflight && *st->inflight == request) ||
+        std::find(st->queued.begin(), st->queued.end(), request) != st->queued.end()) {
+      st->stats.coalesced++;
+      process_tracer().count(trace_counter::launch_coalesced);
+      return true;
+    }
+    st->queued.emplace_back(std::move(request));
+    st->stats.queued++;
+    if (st->running) {
+      return true;
+    }
+    st->running = true;
+  }
+  if (exec([st = st] { drain(st); })) {
+    return true;
+  }
+  return drain(st);
+}
+
+bool launch_queue::drain(const std::shared_ptr<state> &st) {
+  auto all = true;
+  for (;;) {
+    launch_request request;
+    {
+      std::lock_guard lock(st->mu);
+      st->inflight.reset();
+      if (st->queued.empty()) {
+        st->running = false;
+        st->drained.notify_all();
+        return all;
+      }
+      st->inflight.emplace(st->queued.front());
+      request = std::move(st->queued.front());
+      st->queued.pop_front();
+    }
+    auto launched = st->inner->launch(request);
+    process_tracer().count(launched ? trace_counter::launch_succeeded : trace_counter::launch_failed);
+    {
+      std::lock_guard lock(st->mu);
+      if (launched) {
+        st->stats.launched++;
+      } else {
+        st->stats.failed++;
+      }
+    }
+    all = all && launched;
+    if (!launched && st->onFailure) {
+      st->onFailure(request);
+    }
+  }
+}
+
+void launch_queue::wait() {
+  std::unique_lock lock(st->mu);
+  st->drained.wait(lock, [this] { return !st->running; });
+}
+
+bool launch_queue::idle() const {
+  std::lock_guard lock(st->mu);
+  return !st->running;
+}
+
+launch_queue::statistics launch_queue::stats() const {
+  std::lock_guard lock(st->mu);
+  return st->stats;
+}
+
+} // namespace winmenu
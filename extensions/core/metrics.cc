@@ -0,0 +1,69 @@
+///
+#include <cstring>
+#include <new>
+#include <winmenu/metrics.hpp>
+
+namespace winmenu {
+
+bool metrics_block_valid(const metrics_block &block) {
+  return block.magic == metrics_block::magic_value && block.version == metrics_block::version_value &&
+         block.size == sizeof(metrics_block) && block.shards == metric_shards && block.callbacks == metric_callbacks &&
+         block.buckets == metric_buckets && block.counters == metric_counters;
+}
+
+void initialize_metrics_block(metrics_block &block) {
+  auto p = new (&block) metrics_block{};
+  p->magic = metrics_block::magic_value;
+  p->version = metrics_block::version_value;
+  p->size = sizeof(metrics_block);
+  p->shards = metric_shards;
+  p->callbacks = metric_callbacks;
+  p->buckets = metric_buckets;
+  p->counters = metric_counters;
+}
+
+uint64_t latency_snapshot::percentile(double p) const {
+  if (calls == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(calls - 1));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts.size(); i++) {
+    seen += counts[i];
+    if (seen > rank) {
+      return metric_bucket_lower(i);
+    }
+  }
+  return metric_bucket_lower(counts.size() - 1);
+}
+
+latency_snapshot read_latency(const metrics_block &block, trace_callback c) {
+  latency_snapshot snapshot;
+  auto i = static_cast<size_t>(c);
+  for (const auto &s : block.shard) {
+    for (size_t b = 0; b < metric_buckets; b++) {
+      auto n = s.latency[i][b].load(std::memory_order_relaxed);
+      snapshot.counts[b] += n;
+      snapshot.calls += n;
+    }
+    snapshot.sum += s.latency_sum[i].load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+uint64_t read_counter(const metrics_block &block, trace_counter c) {
+  uint64_t n = 0;
+  for (const auto &s : block.shard) {
+    n += s.counters[static_cast<size_t>(c)].load(std::memory_order_relaxed);
+  }
+  return n;
+}
+
+size_t metrics::shard_index() {
+  // threads are spread round robin over the shards on first use
+  static std::atomic<size_t> next{0};
+  thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % metric_shards;
+  return index;
+}
+
+} // namespace winmenu
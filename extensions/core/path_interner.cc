@@ -0,0 +1,232 @@
+///
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <new>
+#include <bela/path_fold.hpp>
+#include <winmenu/path_interner.hpp>
+
+namespace winmenu {
+
+namespace {
+using interner_internal::entry;
+
+entry *make_entry(std::wstring_view path, uint64_t hash) {
+  auto p = ::operator new(sizeof(entry) + (path.size() + 1) * sizeof(wchar_t));
+  auto e = new (p) entry;
+  e->hash = hash;
+  e->size = path.size();
+  auto text = const_cast<wchar_t *>(e->text());
+  std::char_traits<wchar_t>::copy(text, path.data(), path.size());
+  text[path.size()] = 0;
+  return e;
+}
+
+void free_entry(entry *e) {
+  e->~entry();
+  ::operator delete(e);
+}
+
+// take_ref adds a handle unless the entry has been unlinked
+bool take_ref(entry *e) {
+  auto refs = e->refs.load(std::memory_order_relaxed);
+  do {
+    if ((refs & entry::dead) != 0) {
+      return false;
+    }
+  } while (!e->refs.compare_exchange_weak(refs, refs + 1, std::memory_order_acquire, std::memory_order_relaxed));
+  return true;
+}
+
+std::atomic<size_t> readerHints{0};
+} // namespace
+
+// reader_guard publishes the current epoch in a free reader slot for the duration of a lookup. With every slot taken
+// the guard is not engaged and the lookup goes through the lock.
+class path_interner::reader_guard {
+public:
+  explicit reader_guard(path_interner &interner) {
+    thread_local size_t hint = readerHints.fetch_add(1, std::memory_order_relaxed);
+    auto now = interner.epoch.load();
+    for (size_t i = 0; i < reader_slots; i++) {
+      auto &s = interner.readers[(hint + i) % reader_slots];
+      uint64_t idle = 0;
+      if (s.epoch.load(std::memory_order_relaxed) == 0 && s.epoch.compare_exchange_strong(idle, now)) {
+        // the exchange is ordered with the read-modify-write reclaim_locked makes on every slot: either the
+        // sweeper reads this epoch or it came first and this lookup sees its unlinks
+        slot = &s;
+        break;
+      }
+    }
+  }
+  reader_guard(const reader_guard &) = delete;
+  reader_guard &operator=(const reader_guard &) = delete;
+  ~reader_guard() {
+    if (slot != nullptr) {
+      slot->epoch.store(0, std::memory_order_release);
+    }
+  }
+  explicit operator bool() const { return slot != nullptr; }
+
+private:
+  reader_slot *slot{nullptr};
+};
+
+path_interner::path_interner(size_t capacity_) : capacity(std::max<size_t>(capacity_, 1)), threshold(capacity) {
+  auto n = std::bit_ceil(capacity);
+  mask = n - 1;
+  buckets = std::make_unique<std::atomic<entry *>[]>(n);
+}
+
+path_interner::~path_interner() {
+  for (size_t i = 0; i <= mask; i++) {
+    for (auto e = buckets[i].load(std::memory_order_acquire); e != nullptr;) {
+      auto next = e->next.load(std::memory_order_relaxed);
+      if (e->refs.load(std::memory_order_acquire) == 0) {
+        free_entry(e);
+      }
+      e = next;
+    }
+  }
+  while (retired != nullptr) {
+    free_entry(std::exchange(retired, retired->retired_next));
+  }
+}
+
+// lookup walks a bucket and takes a handle on the matching entry, the caller keeps it from being freed
+path_interner::entry *path_interner::lookup(std::wstring_view path, uint64_t hash) {
+  for (auto e = buckets[hash & mask].load(std::memory_order_acquire); e != nullptr;
+       e = e->next.load(std::memory_order_acquire)) {
+    if (e->hash == hash && bela::equal_fold(e->sv(), path) && take_ref(e)) {
+      return e;
+    }
+  }
+  return nullptr;
+}
+
+// acquire is lookup inside an epoch, nullptr when the path is not there or no reader slot was free
+path_interner::entry *path_interner::acquire(std::wstring_view path, uint64_t hash) {
+  reader_guard guard(*this);
+  if (!guard) {
+    return nullptr;
+  }
+  return lookup(path, hash);
+}
+
+interned_path path_interner::intern(std::wstring_view path) {
+  if (path.empty()) {
+    return {};
+  }
+  auto hash = bela::hash_fold(path);
+  if (auto e = acquire(path, hash); e != nullptr) {
+    counters.hits.fetch_add(1, std::memory_order_relaxed);
+    return interned_path(e);
+  }
+  std::lock_guard lock(mu);
+  // unlinking happens under the lock, every linked entry accepts a handle here
+  if (auto e = lookup(path, hash); e != nullptr) {
+    counters.hits.fetch_add(1, std::memory_order_relaxed);
+    return interned_path(e);
+  }
+  if (count >= threshold) {
+    sweep_locked();
+  }
+  auto e = make_entry(path, hash);
+  e->refs.store(1, std::memory_order_relaxed);
+  auto &head = buckets[hash & mask];
+  e->next.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  head.store(e, std::memory_order_release);
+  count++;
+  counters.misses.fetch_add(1, std::memory_order_relaxed);
+  return interned_path(e);
+}
+
+interned_path path_interner::find(std::wstring_view path) {
+  if (path.empty()) {
+    return {};
+  }
+  auto hash = bela::hash_fold(path);
+  auto e = acquire(path, hash);
+  if (e == nullptr) {
+    std::lock_guard lock(mu);
+    e = lookup(path, hash);
+  }
+  if (e != nullptr) {
+    counters.hits.fetch_add(1, std::memory_order_relaxed);
+  }
+  return interned_path(e);
+}
+
+void path_interner::collect() {
+  std::lock_guard lock(mu);
+  sweep_locked();
+}
+
+path_interner::statistics path_interner::snapshot() {
+  statistics st;
+  st.hits = counters.hits.load(std::memory_order_relaxed);
+  st.misses = counters.misses.load(std::memory_order_relaxed);
+  st.reclaimed = counters.reclaimed.load(std::memory_order_relaxed);
+  std::lock_guard lock(mu);
+  st.entries = count;
+  st.retired = retiredCount;
+  return st;
+}
+
+// sweep_locked unlinks the entries without handles. Readers still on an unlinked entry follow its next pointer,
+// which is left as is, back into the table.
+void path_interner::sweep_locked() {
+  auto now = epoch.load(std::memory_order_relaxed);
+  for (size_t i = 0; i <= mask; i++) {
+    auto link = &buckets[i];
+    for (auto e = link->load(std::memory_order_relaxed); e != nullptr;) {
+      auto next = e->next.load(std::memory_order_relaxed);
+      uint32_t unused = 0;
+      if (e->refs.compare_exchange_strong(unused, entry::dead, std::memory_order_acquire, std::memory_order_relaxed)) {
+        link->store(next, std::memory_order_release);
+        e->retired = now;
+        e->retired_next = retired;
+        retired = e;
+        retiredCount++;
+        count--;
+      } else {
+        link = &e->next;
+      }
+      e = next;
+    }
+  }
+  // when most entries are held, sweep again only after the table has doubled
+  threshold = std::max(capacity, count * 2);
+  epoch.fetch_add(1);
+  reclaim_locked();
+}
+
+// reclaim_locked frees the retired entries older than every lookup in progress
+void path_interner::reclaim_locked() {
+  auto oldest = std::numeric_limits<uint64_t>::max();
+  for (auto &s : readers) {
+    // a read-modify-write rather than a load: a reader publishing later reads from it and so sees the unlinks made
+    // before, there is no fence for either side to pair with (and none ThreadSanitizer would follow)
+    if (auto v = s.epoch.fetch_add(0, std::memory_order_acq_rel); v != 0) {
+      oldest = std::min(oldest, v);
+    }
+  }
+  for (auto link = &retired; *link != nullptr;) {
+    auto e = *link;
+    if (e->retired < oldest) {
+      *link = e->retired_next;
+      free_entry(e);
+      retiredCount--;
+      counters.reclaimed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      link = &e->retired_next;
+    }
+  }
+}
+
+path_interner &process_interner() {
+  static path_interner interner;
+  return interner;
+}
+
+} // namespace winmenu
@@ -0,0 +1,31 @@
+///
+#include <winmenu/selection.hpp>
+
+namespace winmenu {
+
+std::optional<selection_facts> classify_selection(shell_item_list &items) {
+  auto count = items.count();
+  if (count == 0) {
+    return std::nullopt;
+  }
+  uint32_t all = 0;
+  uint32_t any = 0;
+  if (!items.attributes(item_classified, all, any)) {
+    return std::nullopt;
+  }
+  selection_facts facts;
+  facts.count = count;
+  facts.filesystem = (all & item_filesystem) != 0;
+  facts.directory = (all & item_folder) != 0;
+  facts.any_directory = (any & item_folder) != 0;
+  return std::make_optional(facts);
+}
+
+void selection_classifier::reset() {
+  std::lock_guard lock(mu);
+  current = nullptr;
+  valid = false;
+  facts.reset();
+}
+
+} // namespace winmenu
@@ -0,0 +1,272 @@
+///
+#include <algorithm>
+#include <cstddef>
+#include <winmenu/trace.hpp>
+#include <winmenu/metrics.hpp>
+
+namespace winmenu {
+
+namespace {
+struct ring_header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t capacity;
+  uint64_t next;
+};
+static_assert(sizeof(ring_header) == 32);
+
+std::FILE *open_file(const std::filesystem::path &path, bool create) {
+#if defined(_WIN32)
+  return _wfopen(path.c_str(), create ? L"w+b" : L"r+b");
+#else
+  return std::fopen(path.c_str(), create ? "w+b" : "r+b");
+#endif
+}
+
+uint64_t unix_nanoseconds() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+// percentile returns the value below which p percent of the sorted durations fall
+uint64_t percentile(const std::vector<uint64_t> &sorted, size_t p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  return sorted[(sorted.size() - 1) * p / 100];
+}
+} // namespace
+
+const char *trace_callback_name(trace_callback c) {
+  switch (c) {
+  case trace_callback::get_title:
+    return "GetTitle";
+  case trace_callback::get_icon:
+    return "GetIcon";
+  case trace_callback::get_tooltip:
+    return "GetToolTip";
+  case trace_callback::get_canonical_name:
+    return "GetCanonicalName";
+  case trace_callback::get_state:
+    return "GetState";
+  case trace_callback::invoke:
+    return "Invoke";
+  case trace_callback::get_flags:
+    return "GetFlags";
+  case trace_callback::enum_sub_commands:
+    return "EnumSubCommands";
+  default:
+    break;
+  }
+  return "unknown";
+}
+
+const char *trace_counter_name(trace_counter c) {
+  switch (c) {
+  case trace_counter::registry_read:
+    return "registry reads";
+  case trace_counter::filesystem_probe:
+    return "filesystem probes";
+  case trace_counter::launch_succeeded:
+    return "processes spawned";
+  case trace_counter::launch_failed:
+    return "launches failed";
+  case trace_counter::launch_coalesced:
+    return "launches coalesced";
+  case trace_counter::cache_hit:
+    return "cache hits";
+  case trace_counter::cache_miss:
+    return "cache misses";
+  case trace_counter::command_line_bytes:
+    return "command line bytes";
+  case trace_counter::storage_allocated:
+    return "pooled blocks allocated";
+  case trace_counter::storage_recycled:
+    return "pooled blocks recycled";
+  default:
+    break;
+  }
+  return "unknown";
+}
+
+tracer::tracer() : owned(std::make_unique<metrics_block>()) {
+  initialize_metrics_block(*owned);
+  current.store(owned.get(), std::memory_order_release);
+}
+
+tracer::~tracer() = default;
+
+void tracer::attach(metrics_block *block) {
+  auto previous = current.load(std::memory_order_acquire);
+  if (block == nullptr || block == previous) {
+    return;
+  }
+  auto &to = block->shard[0];
+  for (const auto &from : previous->shard) {
+    for (size_t c = 0; c < metric_callbacks; c++) {
+      for (size_t b = 0; b < metric_buckets; b++) {
+        to.latency[c][b].fetch_add(from.latency[c][b].load(std::memory_order_relaxed), std::memory_order_relaxed);
+      }
+      to.latency_sum[c].fetch_add(from.latency_sum[c].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    for (size_t c = 0; c < metric_counters; c++) {
+      to.counters[c].fetch_add(from.counters[c].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+  }
+  current.store(block, std::memory_order_release);
+}
+
+metrics tracer::stats() const { return metrics(current.load(std::memory_order_acquire)); }
+
+void tracer::callback(trace_callback c, clock::duration elapsed) {
+  auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  metrics(current.load(std::memory_order_acquire)).record(c, ns);
+  if (hasSinks.load(std::memory_order_acquire)) {
+    emit(trace_record{unix_nanoseconds(), ns, trace_kind::callback, static_cast<uint16_t>(c)});
+  }
+}
+
+void tracer::count(trace_counter c, uint64_t n) {
+  metrics(current.load(std::memory_order_acquire)).add(c, n);
+  if (hasSinks.load(std::memory_order_acquire)) {
+    emit(trace_record{unix_nanoseconds(), 0, trace_kind::counter, static_cast<uint16_t>(c),
+                      static_cast<uint32_t>(std::min<uint64_t>(n, UINT32_MAX))});
+  }
+}
+
+void tracer::add_sink(std::shared_ptr<trace_sink> sink) {
+  if (!sink) {
+    return;
+  }
+  std::unique_lock lock(mu);
+  sinks.emplace_back(std::move(sink));
+  hasSinks.store(true, std::memory_order_release);
+}
+
+void tracer::remove_sink(const trace_sink *sink) {
+  std::unique_lock lock(mu);
+  std::erase_if(sinks, [sink](const auto &s) { return s.get() == sink; });
+  hasSinks.store(!sinks.empty(), std::memory_order_release);
+}
+
+void tracer::clear_sinks() {
+  std::unique_lock lock(mu);
+  sinks.clear();
+  hasSinks.store(false, std::memory_order_release);
+}
+
+void tracer::emit(const trace_record &r) {
+  std::shared_lock lock(mu);
+  for (const auto &s : sinks) {
+    s->record(r);
+  }
+}
+
+tracer &process_tracer() {
+  static tracer t;
+  return t;
+}
+
+ring_file_sink::ring_file_sink(const std::filesystem::path &path, uint64_t capacity_) : capacity(capacity_) {
+  if (capacity == 0) {
+    return;
+  }
+  ring_header h{};
+  if (fd = open_file(path, false); fd != nullptr) {
+    if (std::fread(&h, sizeof(h), 1, fd) == 1 && h.magic == magic && h.version == version &&
+        h.record_size == sizeof(trace_record) && h.capacity == capacity) {
+      next = h.next;
+      return;
+    }
+    std::fclose(fd);
+  }
+  if (fd = open_file(path, true); fd == nullptr) {
+    return;
+  }
+  h = ring_header{magic, version, sizeof(trace_record), capacity, 0};
+  if (std::fwrite(&h, sizeof(h), 1, fd) != 1 || std::fflush(fd) != 0) {
+    std::fclose(fd);
+    fd = nullptr;
+  }
+}
+
+ring_file_sink::~ring_file_sink() {
+  if (fd != nullptr) {
+    std::fclose(fd);
+  }
+}
+
+void ring_file_sink::record(const trace_record &r) {
+  std::lock_guard lock(mu);
+  if (fd == nullptr) {
+    return;
+  }
+  auto offset = sizeof(ring_header) + (next % capacity) * sizeof(trace_record);
+  if (std::fseek(fd, static_cast<long>(offset), SEEK_SET) != 0 || std::fwrite(&r, sizeof(r), 1, fd) != 1) {
+    return;
+  }
+  next++;
+  // the header goes last, a reader never sees a sequence number ahead of its record
+  if (std::fseek(fd, offsetof(ring_header, next), SEEK_SET) == 0) {
+    std::fwrite(&next, sizeof(next), 1, fd);
+  }
+  std::fflush(fd);
+}
+
+bool read_trace_ring(const std::filesystem::path &path, std::vector<trace_record> &records) {
+  auto fd = open_file(path, false);
+  if (fd == nullptr) {
+    return false;
+  }
+  ring_header h{};
+  auto ok = std::fread(&h, sizeof(h), 1, fd) == 1 && h.magic == ring_file_sink::magic &&
+            h.version == ring_file_sink::version && h.record_size == sizeof(trace_record) && h.capacity != 0;
+  if (ok) {
+    std::vector<trace_record> slots(static_cast<size_t>(std::min(h.next, h.capacity)));
+    ok = slots.empty() || std::fread(slots.data(), sizeof(trace_record), slots.size(), fd) == slots.size();
+    if (ok) {
+      // oldest first: the slot after the newest record when the ring has wrapped
+      auto first = h.next > h.capacity ? static_cast<size_t>(h.next % h.capacity) : 0;
+      records.clear();
+      records.reserve(slots.size());
+      records.insert(records.end(), slots.begin() + first, slots.end());
+      records.insert(records.end(), slots.begin(), slots.begin() + first);
+    }
+  }
+  std::fclose(fd);
+  return ok;
+}
+
+trace_summary summarize_trace(std::span<const trace_record> records) {
+  trace_summary summary;
+  std::array<std::vector<uint64_t>, static_cast<size_t>(trace_callback::count_)> durations;
+  for (const auto &r : records) {
+    if (r.kind == trace_kind::callback && r.id < durations.size()) {
+      durations[r.id].push_back(r.duration);
+      continue;
+    }
+    if (r.kind == trace_kind::counter && r.id < summary.counters.size()) {
+      summary.counters[r.id] += r.value;
+    }
+  }
+  for (size_t i = 0; i < durations.size(); i++) {
+    auto &d = durations[i];
+    if (d.empty()) {
+      continue;
+    }
+    std::sort(d.begin(), d.end());
+    auto &l = summary.callbacks[i];
+    l.calls = d.size();
+    for (auto v : d) {
+      l.total += v;
+    }
+    l.p50 = percentile(d, 50);
+    l.p99 = percentile(d, 99);
+    l.max = d.back();
+  }
+  return summary;
+}
+
+} // namespace winmenu
@@ -0,0 +1,47 @@
+///
+#include <winmenu/verb_state.hpp>
+
+namespace winmenu {
+
+verb_state decide_verb_state(bool installed, const std::optional<selection_facts> &facts) {
+  if (!installed || !facts || !facts->filesystem) {
+    return verb_state::hidden;
+  }
+  return verb_state::enabled;
+}
+
+verb_state verb_state_machine::query(const void *selectionKey, bool okToBeSlow, state_probe &probe,
+                                     clock::time_point now) {
+  if (auto installed = probe.installed_cached(); installed && !*installed) {
+    return verb_state::hidden;
+  }
+  {
+    std::lock_guard lock(mu);
+    if (last != verb_state::pending && key == selectionKey && now - evaluated < ttl) {
+      return last;
+    }
+  }
+  if (!okToBeSlow) {
+    return verb_state::pending;
+  }
+  auto state = verb_state::hidden;
+  if (probe.installed()) {
+    state = decide_verb_state(true, probe.selection());
+  }
+  std::lock_guard lock(mu);
+  if (key != selectionKey) {
+    probe.hold();
+  }
+  key = selectionKey;
+  evaluated = now;
+  last = state;
+  return state;
+}
+
+void verb_state_machine::reset() {
+  std::lock_guard lock(mu);
+  key = nullptr;
+  last = verb_state::pending;
+}
+
+} // namespace winmenu
@@ -0,0 +1,95 @@
+///
+#include <winmenu/verb_table.hpp>
+#include <winmenu/invoke.hpp>
+
+namespace winmenu::verbs {
+
+std::optional<bool> code_installed_cached(verb_services &services) {
+  std::shared_ptr<const code_config> cfg;
+  if (!services.code_cached(cfg)) {
+    return std::nullopt;
+  }
+  return cfg != nullptr;
+}
+
+bool code_installed(verb_services &services) { return services.code() != nullptr; }
+
+bool code_icon(verb_services &services, std::wstring &path) {
+  auto cfg = services.code();
+  if (!cfg || cfg->icon.empty()) {
+    return false;
+  }
+  path = cfg->icon;
+  return true;
+}
+
+size_t code_invoke(verb_services &services, shell_item_list &items, process_launcher &launcher) {
+  auto cfg = services.code();
+  if (!cfg) {
+    return 0;
+  }
+  // batching is always on for the menu verb: Code.exe opens every path of one command line in the same window, like
+  // the installer's verb does for a multi-item selection, instead of racing one process per item
+  return invoke_code(*cfg, items, launcher, true);
+}
+
+std::optional<bool> git_installed_cached(verb_services &services) {
+  std::shared_ptr<const git_install> gi;
+  if (!services.git_cached(gi)) {
+    return std::nullopt;
+  }
+  return gi != nullptr;
+}
+
+bool git_installed(verb_services &services) { return services.git() != nullptr; }
+
+bool git_icon(verb_services &services, std::wstring &path) {
+  auto gi = services.git();
+  if (!gi) {
+    return false;
+  }
+  path = gi->git_bash;
+  return true;
+}
+
+size_t git_invoke(verb_services &services, shell_item_list &items, process_launcher &launcher) {
+  auto gi = services.git();
+  std::wstring directory;
+  if (!gi || items.count() == 0 || !items.path(0, directory)) {
+    return 0;
+  }
+  return invoke_git_bash(*gi, directory, launcher) ? 1 : 0;
+}
+
+std::optional<bool> git_gui_installed_cached(verb_services &services) {
+  std::shared_ptr<const git_install> gi;
+  if (!services.git_cached(gi)) {
+    return std::nullopt;
+  }
+  return gi != nullptr && !gi->git_gui.empty();
+}
+
+bool git_gui_installed(verb_services &services) {
+  auto gi = services.git();
+  return gi != nullptr && !gi->git_gui.empty();
+}
+
+bool git_gui_icon(verb_services &services, std::wstring &path) {
+  auto gi = services.git();
+  if (!gi || gi->git_gui.empty()) {
+    return false;
+  }
+  path = gi->git_gui;
+  return true;
+}
+
+size_t git_gui_invoke(verb_services &services, shell_item_list &items, process_launcher &launcher) {
+  auto gi = services.git();
+  std::wstring directory;
+  if (!gi || items.count() == 0 || !items.path(0, directory)) {
+    return 0;
+  }
+  return invoke_git_gui(*gi, directory, launcher) ? 1 : 0;
+}
+
+} // namespace winmenu::verbs
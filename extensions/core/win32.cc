@@ -0,0 +1,385 @@
+///
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <bela/path_buffer.hpp>
+#include <winmenu/win32.hpp>
+#include <TraceLoggingProvider.h>
+
+// {2F4C1B67-5E0D-4F8A-9C21-7B8E6D3A4F15}
+TRACELOGGING_DEFINE_PROVIDER(winmenuTraceProvider, "WinMenu",
+                             (0x2f4c1b67, 0x5e0d, 0x4f8a, 0x9c, 0x21, 0x7b, 0x8e, 0x6d, 0x3a, 0x4f, 0x15));
+
+namespace winmenu::win32 {
+constexpr auto ok = ERROR_SUCCESS;
+
+namespace {
+// on_provider_enable follows ETW sessions enabling and disabling the provider, capture state requests change nothing
+void NTAPI on_provider_enable(LPCGUID, ULONG controlCode, UCHAR, ULONGLONG, ULONGLONG, PEVENT_FILTER_DESCRIPTOR,
+                              PVOID context) {
+  if (controlCode == EVENT_CONTROL_CODE_ENABLE_PROVIDER || controlCode == EVENT_CONTROL_CODE_DISABLE_PROVIDER) {
+    static_cast<tracelogging_sink *>(context)->enable(controlCode == EVENT_CONTROL_CODE_ENABLE_PROVIDER);
+  }
+}
+} // namespace
+
+std::shared_ptr<tracelogging_sink> tracelogging_sink::Create(tracer &t) {
+  // owned before registering: a session already listening enables the provider from within TraceLoggingRegisterEx
+  std::shared_ptr<tracelogging_sink> sink(new tracelogging_sink(t));
+  sink->registered = SUCCEEDED(TraceLoggingRegisterEx(winmenuTraceProvider, on_provider_enable, sink.get()));
+  return sink;
+}
+
+tracelogging_sink::~tracelogging_sink() {
+  if (registered) {
+    TraceLoggingUnregister(winmenuTraceProvider);
+  }
+}
+
+void tracelogging_sink::enable(bool on) {
+  std::lock_guard lock(mu);
+  if (on == added) {
+    return;
+  }
+  added = on;
+  if (on) {
+    t.add_sink(shared_from_this());
+    return;
+  }
+  t.remove_sink(this);
+}
+
+void tracelogging_sink::record(const trace_record &r) {
+  // a session may filter on level or keyword
+  if (!TraceLoggingProviderEnabled(winmenuTraceProvider, 0, 0)) {
+    return;
+  }
+  if (r.kind == trace_kind::callback) {
+    TraceLoggingWrite(winmenuTraceProvider, "Callback",
+                      TraceLoggingString(trace_callback_name(static_cast<trace_callback>(r.id)), "Name"),
+                      TraceLoggingUInt64(r.duration, "DurationNs"));
+    return;
+  }
+  TraceLoggingWrite(winmenuTraceProvider, "Counter",
+                    TraceLoggingString(trace_counter_name(static_cast<trace_counter>(r.id)), "Name"));
+}
+
+std::wstring metrics_mapping_name(std::wstring_view tag, DWORD pid) {
+  return std::format(L"Local\\WinMenu.Metrics.{}.{}", tag, pid);
+}
+
+metrics_block *create_metrics_block(const std::wstring &name) {
+  // the handle is not closed: the mapping stays for the lifetime of the process, like the tracer using it
+  auto mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                    static_cast<DWORD>(sizeof(metrics_block)), name.c_str());
+  if (mapping == nullptr) {
+    return nullptr;
+  }
+  auto view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(metrics_block));
+  if (view == nullptr) {
+    CloseHandle(mapping);
+    return nullptr;
+  }
+  auto block = static_cast<metrics_block *>(view);
+  initialize_metrics_block(*block);
+  return block;
+}
+
+const metrics_block *open_metrics_block(const std::wstring &name) {
+  auto mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, name.c_str());
+  if (mapping == nullptr) {
+    return nullptr;
+  }
+  // the view keeps the mapping alive
+  auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(metrics_block));
+  CloseHandle(mapping);
+  if (view == nullptr) {
+    return nullptr;
+  }
+  auto block = static_cast<const metrics_block *>(view);
+  if (!metrics_block_valid(*block)) {
+    UnmapViewOfFile(view);
+    return nullptr;
+  }
+  return block;
+}
+
+tracer &process_trace(std::wstring_view tag) {
+  static std::once_flag once;
+  std::call_once(once, [tag] {
+    auto &t = process_tracer();
+    t.attach(create_metrics_block(metrics_mapping_name(tag, GetCurrentProcessId())));
+    // kept for the lifetime of the process, the tracer only holds it while a session listens
+    static auto events = tracelogging_sink::Create(t);
+    registry_config_source source;
+    auto dir = source.environment(L"WINMENU_TRACE_DIR");
+    if (!dir || dir->empty()) {
+      return;
+    }
+    auto name = std::format(L"winmenu-{}-{}.trace", tag, GetCurrentProcessId());
+    auto sink = std::make_shared<ring_file_sink>(std::filesystem::path(*dir) / name);
+    if (sink->is_open()) {
+      t.add_sink(std::move(sink));
+    }
+  });
+  return process_tracer();
+}
+
+HKEY registry_root_key(registry_root root) {
+  return root == registry_root::local_machine ? HKEY_LOCAL_MACHINE : HKEY_CURRENT_USER;
+}
+
+std::optional<std::wstring> GitForWindowsInstallPath(bela::error_code &ec) {
+  HKEY hkey = nullptr;
+  LSTATUS status = ERROR_FILE_NOT_FOUND;
+  for (const auto &k : git_install_keys) {
+    std::wstring subKey(k.path);
+    process_tracer().count(trace_counter::registry_read);
+    if (status = RegOpenKeyW(registry_root_key(k.root), subKey.c_str(), &hkey); status == ok) {
+      break;
+    }
+  }
+  if (status != ok) {
+    ec = bela::make_error_code_from_system(status);
+    return std::nullopt;
+  }
+  auto closer = bela::finally([&] { RegCloseKey(hkey); });
+  // registry functions return their error, GetLastError is not set. InstallPath nearly always fits in MAX_PATH,
+  // a longer value reports its size with ERROR_MORE_DATA and is read again into a buffer that large.
+  bela::path_buffer path;
+  DWORD type = 0;
+  DWORD bufsize = static_cast<DWORD>(path.capacity() * sizeof(wchar_t));
+  for (;;) {
+    auto data = reinterpret_cast<LPBYTE>(path.ResizeForOverwrite((bufsize + 1) / sizeof(wchar_t)));
+    process_tracer().count(trace_counter::registry_read);
+    if (status = RegQueryValueExW(hkey, L"InstallPath", nullptr, &type, data, &bufsize); status != ERROR_MORE_DATA) {
+      break;
+    }
+  }
+  if (status != ok) {
+    ec = bela::make_error_code_from_system(status);
+    return std::nullopt;
+  }
+  if (type != REG_SZ) {
+    ec = bela::make_error_code_from_system(ERROR_DATATYPE_MISMATCH);
+    return std::nullopt;
+  }
+  // the stored value may or may not include its terminator
+  path.Truncate(bufsize / sizeof(wchar_t));
+  path.Truncate(std::min(path.sv().find(L'\0'), path.size()));
+  return std::make_optional(path.str());
+}
+
+// every registry call counts as one registry_read, the counter matches the calls a trace of the process shows
+std::optional<std::wstring> registry_config_source::read_string(std::wstring_view key, std::wstring_view name) {
+  std::wstring subKey(key);
+  std::wstring valueName(name);
+  constexpr DWORD flags = RRF_RT_REG_SZ | RRF_RT_REG_EXPAND_SZ | RRF_NOEXPAND;
+  DWORD size = 0;
+  process_tracer().count(trace_counter::registry_read);
+  if (RegGetValueW(HKEY_CLASSES_ROOT, subKey.c_str(), valueName.c_str(), flags, nullptr, nullptr, &size) != ok) {
+    return std::nullopt;
+  }
+  std::wstring value(size / sizeof(wchar_t) + 1, L'\0');
+  size = static_cast<DWORD>(value.size() * sizeof(wchar_t));
+  process_tracer().count(trace_counter::registry_read);
+  if (RegGetValueW(HKEY_CLASSES_ROOT, subKey.c_str(), valueName.c_str(), flags, nullptr, value.data(), &size) != ok) {
+    return std::nullopt;
+  }
+  value.resize(wcsnlen(value.data(), value.size()));
+  return std::make_optional(std::move(value));
+}
+
+std::optional<std::wstring> registry_config_source::environment(std::wstring_view name) {
+  std::wstring key(name);
+  auto n = GetEnvironmentVariableW(key.c_str(), nullptr, 0);
+  if (n == 0) {
+    return std::nullopt;
+  }
+  std::wstring value(n, L'\0');
+  n = GetEnvironmentVariableW(key.c_str(), value.data(), n);
+  if (n == 0 || n >= value.size()) {
+    return std::nullopt;
+  }
+  value.resize(n);
+  return std::make_optional(std::move(value));
+}
+
+bool registry_code_config_watcher::watch(std::function<void()> changed) {
+  watcher.reset();
+  auto onChanged = [changed](wil::RegistryChangeKind) { changed(); };
+  std::wstring shellKey(code_shell_key);
+  watcher = wil::make_registry_watcher_nothrow(HKEY_CLASSES_ROOT, shellKey.c_str(), true, onChanged);
+  if (!watcher) {
+    // VS Code is not installed, wait for its verb key to be created
+    watcher = wil::make_registry_watcher_nothrow(HKEY_CLASSES_ROOT, LR"(*\shell)", false, onChanged);
+  }
+  return static_cast<bool>(watcher);
+}
+
+// GitForWindowsInstallPath counts each key it opens and each value query
+std::optional<std::wstring> registry_git_install_backend::install_path() {
+  bela::error_code ec;
+  return GitForWindowsInstallPath(ec);
+}
+
+bool registry_git_install_backend::watch(std::function<void()> changed) {
+  watchers.clear();
+  for (const auto &k : git_install_keys) {
+    // watch the key itself, or its nearest existing parent until it is created
+    std::wstring subKey(k.path);
+    for (;;) {
+      auto watcher = wil::make_registry_watcher_nothrow(registry_root_key(k.root), subKey.c_str(), false,
+                                                        [changed](wil::RegistryChangeKind) { changed(); });
+      if (watcher) {
+        watchers.emplace_back(std::move(watcher));
+        break;
+      }
+      auto pos = subKey.rfind(L'\\');
+      if (pos == std::wstring::npos) {
+        watchers.clear();
+        return false;
+      }
+      subKey.resize(pos);
+    }
+  }
+  return true;
+}
+
+bool filesystem::exists(std::wstring_view path) {
+  process_tracer().count(trace_counter::filesystem_probe);
+  bela::path_buffer p(path);
+  auto attr = GetFileAttributesW(p.MakeExtended().c_str());
+  return attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY) == 0;
+}
+
+bool create_process_launcher::launch(launch_request &request) {
+  PROCESS_INFORMATION pi;
+  STARTUPINFOEXW siEx{0};
+  siEx.StartupInfo.cb = sizeof(STARTUPINFOEX);
+  if (CreateProcessW(request.application.empty() ? nullptr : request.application.c_str(), // lpApplicationName
+                     request.command_line.data(),
+                     nullptr,                                                   // lpProcessAttributes
+                     nullptr,                                                   // lpThreadAttributes
+                     false,                                                     // bInheritHandles
+                     EXTENDED_STARTUPINFO_PRESENT | CREATE_UNICODE_ENVIRONMENT, // dwCreationFlags
+                     nullptr,                                                   // lpEnvironment
+                     request.directory.empty() ? nullptr : request.directory.c_str(),
+                     &siEx.StartupInfo, // lpStartupInfo
+                     &pi                // lpProcessInformation
+                     ) != TRUE) {
+    return false;
+  }
+  CloseHandle(pi.hThread);
+  CloseHandle(pi.hProcess);
+  return true;
+}
+
+namespace {
+struct threadpool_work {
+  std::function<void()> work;
+  HMODULE module{nullptr};
+};
+
+void CALLBACK threadpool_callback(PTP_CALLBACK_INSTANCE instance, PVOID context) {
+  std::unique_ptr<threadpool_work> w(static_cast<threadpool_work *>(context));
+  FreeLibraryWhenCallbackReturns(instance, w->module);
+  w->work();
+}
+} // namespace
+
+bool submit_threadpool_work(std::function<void()> work) {
+  HMODULE module = nullptr;
+  if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
+                         reinterpret_cast<LPCWSTR>(&threadpool_callback), &module) != TRUE) {
+    return false;
+  }
+  auto w = new (std::nothrow) threadpool_work{std::move(work), module};
+  if (w == nullptr) {
+    FreeLibrary(module);
+    return false;
+  }
+  if (TrySubmitThreadpoolCallback(threadpool_callback, w, nullptr) != TRUE) {
+    delete w;
+    FreeLibrary(module);
+    return false;
+  }
+  return true;
+}
+
+size_t shell_item_array::count() {
+  DWORD n = 0;
+  if (items == nullptr || FAILED(items->GetCount(&n))) {
+    return 0;
+  }
+  return n;
+}
+
+bool shell_item_array::path(size_t index, std::wstring &out) {
+  Microsoft::WRL::ComPtr<IShellItem> psi;
+  if (FAILED(items->GetItemAt(static_cast<DWORD>(index), &psi))) {
+    return false;
+  }
+  wil::unique_cotaskmem_string name;
+  if (FAILED(psi->GetDisplayName(SIGDN_FILESYSPATH, &name))) {
+    return false;
+  }
+  out.assign(name.get());
+  return true;
+}
+
+bool shell_item_array::copy_path(size_t index, scratch_arena &arena, std::wstring_view &out) {
+  Microsoft::WRL::ComPtr<IShellItem> psi;
+  if (FAILED(items->GetItemAt(static_cast<DWORD>(index), &psi))) {
+    return false;
+  }
+  // the CoTaskMem name is released as soon as the arena holds its copy
+  wil::unique_cotaskmem_string name;
+  if (FAILED(psi->GetDisplayName(SIGDN_FILESYSPATH, &name))) {
+    return false;
+  }
+  out = arena.copy(name.get());
+  return true;
+}
+
+bool shell_item_array::attributes(uint32_t mask, uint32_t &all, uint32_t &any) {
+  SFGAOF andAttributes = 0;
+  SFGAOF orAttributes = 0;
+  if (items == nullptr || FAILED(items->GetAttributes(SIATTRIBFLAGS_AND, mask, &andAttributes)) ||
+      FAILED(items->GetAttributes(SIATTRIBFLAGS_OR, mask, &orAttributes))) {
+    return false;
+  }
+  all = static_cast<uint32_t>(andAttributes);
+  any = static_cast<uint32_t>(orAttributes);
+  return true;
+}
+
+bool shell_item::path(size_t index, std::wstring &out) {
+  wil::unique_cotaskmem_string name;
+  if (item == nullptr || index != 0 || FAILED(item->GetDisplayName(SIGDN_FILESYSPATH, &name))) {
+    return false;
+  }
+  out.assign(name.get());
+  return true;
+}
+
+bool shell_item::copy_path(size_t index, scratch_arena &arena, std::wstring_view &out) {
+  wil::unique_cotaskmem_string name;
+  if (item == nullptr || index != 0 || FAILED(item->GetDisplayName(SIGDN_FILESYSPATH, &name))) {
+    return false;
+  }
+  out = arena.copy(name.get());
+  return true;
+}
+
+bool shell_item::attributes(uint32_t mask, uint32_t &all, uint32_t &any) {
+  SFGAOF attributes = 0;
+  if (item == nullptr || FAILED(item->GetAttributes(mask, &attributes))) {
+    return false;
+  }
+  all = any = static_cast<uint32_t>(attributes);
+  return true;
+}
+
+} // namespace winmenu::win32
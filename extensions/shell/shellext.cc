@@ -0,0 +1,386 @@
+// WinMenu shell extension: one module serving every row of winmenu::verb_table
+
+// The IExplorerCommand plumbing started from
+// https://github.com/microsoft/AppModelSamples/Samples/SparsePackages/PhotoStoreContextMenu/dllmain.cpp
+
+#define WIN32_LEAN_AND_MEAN // Exclude rarely-used stuff from Windows headers
+#include <windows.h>
+#include <shlwapi.h>
+#include <shobjidl_core.h>
+#include <ShlObj.h>
+#include <wrl/client.h>
+#include <wrl/implements.h>
+#include <wrl/module.h>
+#include <wil/resource.h>
+#include <wil/registry.h>
+#include <string>
+#include <winmenu/code_config.hpp>
+#include <winmenu/git_install.hpp>
+#include <winmenu/launch_queue.hpp>
+#include <winmenu/storage_pool.hpp>
+#include <winmenu/selection.hpp>
+#include <winmenu/trace.hpp>
+#include <winmenu/verb_state.hpp>
+#include <winmenu/verb_table.hpp>
+#include <winmenu/win32.hpp>
+
+using namespace Microsoft::WRL;
+
+// The VS Code verb is resolved once per process and dropped whenever its registry key changes. When the key cannot be
+// watched the result is reused for a while instead, a missing VS Code is probed again after 10 seconds.
+winmenu::win32::registry_config_source codeConfigSource;
+winmenu::win32::registry_code_config_watcher codeConfigWatcher;
+winmenu::code_config_cache codeConfigCache(codeConfigSource, codeConfigWatcher);
+
+winmenu::win32::registry_git_install_backend gitInstallBackend;
+winmenu::win32::filesystem gitInstallFilesystem;
+winmenu::git_install_cache gitInstallCache(gitInstallBackend, gitInstallFilesystem);
+
+// The resolvers every verb of the module shares
+class Services final : public winmenu::verb_services {
+public:
+  bool code_cached(std::shared_ptr<const winmenu::code_config> &cfg) override { return codeConfigCache.peek(cfg); }
+  std::shared_ptr<const winmenu::code_config> code() override { return codeConfigCache.get(); }
+  bool git_cached(std::shared_ptr<const winmenu::git_install> &gi) override { return gitInstallCache.peek(gi); }
+  std::shared_ptr<const winmenu::git_install> git() override { return gitInstallCache.get(); }
+};
+Services services;
+
+// Invoke only queues the launch, CreateProcessW runs on the thread pool so a slow scan of the tool does not freeze
+// Explorer. A failed launch means a cached command or git-bash.exe moved without a registry change, resolve again.
+winmenu::launch_queue launcher(
+    std::make_shared<winmenu::win32::create_process_launcher>(),
+    [](const winmenu::launch_request &) {
+      codeConfigCache.invalidate();
+      gitInstallCache.invalidate();
+    },
+    winmenu::win32::submit_threadpool_work);
+
+// Trace times an IExplorerCommand callback until the end of the enclosing scope
+inline winmenu::tracer::scope Trace(winmenu::trace_callback c) {
+  return winmenu::win32::process_trace(L"winmenu").time(c);
+}
+
+// PoolAllocate takes the storage of a COM object from its pool and counts whether the pool had a block to recycle
+template <typename Pool> void *PoolAllocate(Pool &pool) noexcept {
+  bool recycled = false;
+  auto p = pool.allocate(&recycled);
+  if (p != nullptr) {
+    winmenu::win32::process_trace(L"winmenu").count(recycled ? winmenu::trace_counter::storage_recycled
+                                                             : winmenu::trace_counter::storage_allocated);
+  }
+  return p;
+}
+
+BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserved) {
+  if (ul_reason_for_call == DLL_PROCESS_ATTACH) {
+    DisableThreadLibraryCalls(hModule);
+  }
+  return TRUE;
+}
+
+// VerbCommand is the IExplorerCommand of one verb_table row. Every opening of a submenu builds its children again, so
+// their storage is recycled through a pool. The constructor is private, Create is the only way to build one; Make
+// would take the storage from the heap and park it in the pool on release.
+class VerbCommand final
+    : public RuntimeClass<RuntimeClassFlags<ClassicCom | InhibitFtmBase>, IExplorerCommand, IObjectWithSite> {
+public:
+  static ComPtr<VerbCommand> Create(const winmenu::verb_descriptor *verb, IUnknown *site) {
+    ComPtr<VerbCommand> command;
+    command.Attach(new (std::nothrow) VerbCommand(verb));
+    if (command && site != nullptr) {
+      command->SetSite(site);
+    }
+    return command;
+  }
+  static void *operator new(size_t, const std::nothrow_t &) noexcept { return PoolAllocate(Pool()); }
+  static void operator delete(void *p, const std::nothrow_t &) noexcept { Pool().deallocate(p); }
+  static void operator delete(void *p) noexcept { Pool().deallocate(p); }
+
+  // IExplorerCommand
+  IFACEMETHODIMP GetTitle(_In_opt_ IShellItemArray *, _Outptr_result_nullonfailure_ PWSTR *name) {
+    auto trace = Trace(winmenu::trace_callback::get_title);
+    *name = nullptr;
+    return SHStrDupW(verb->title.data(), name);
+  }
+  IFACEMETHODIMP GetIcon(_In_opt_ IShellItemArray *, _Outptr_result_nullonfailure_ PWSTR *icon) {
+    auto trace = Trace(winmenu::trace_callback::get_icon);
+    *icon = nullptr;
+    std::wstring path;
+    if (!verb->icon(services, path)) {
+      return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    }
+    return SHStrDupW(path.c_str(), icon);
+  }
+  IFACEMETHODIMP GetToolTip(_In_opt_ IShellItemArray *, _Outptr_result_nullonfailure_ PWSTR *infoTip) {
+    auto trace = Trace(winmenu::trace_callback::get_tooltip);
+    *infoTip = nullptr;
+    return E_NOTIMPL;
+  }
+  IFACEMETHODIMP GetCanonicalName(_Out_ GUID *guidCommandName) {
+    auto trace = Trace(winmenu::trace_callback::get_canonical_name);
+    *guidCommandName = winmenu::win32::to_guid(verb->clsid);
+    return S_OK;
+  }
+  IFACEMETHODIMP GetState(_In_opt_ IShellItemArray *selection, _In_ BOOL okToBeSlow, _Out_ EXPCMDSTATE *cmdState) {
+    auto trace = Trace(winmenu::trace_callback::get_state);
+    // Resolving the tool and classifying the selection may do IO. Without fOkToBeSlow only cached answers are given,
+    // otherwise E_PENDING makes Explorer call back on a background thread.
+    StateProbe probe(this, selection);
+    auto state = m_state.query(selection, okToBeSlow != FALSE, probe, winmenu::verb_state_machine::clock::now());
+    return winmenu::win32::command_state(state, cmdState);
+  }
+  IFACEMETHODIMP Invoke(_In_opt_ IShellItemArray *selection, _In_opt_ IBindCtx *) noexcept try {
+    auto trace = Trace(winmenu::trace_callback::invoke);
+    if (verb->submenu()) {
+      return E_NOTIMPL;
+    }
+    auto facts = Classify(selection);
+    if (!facts || !facts->filesystem || !winmenu::verb_applies(verb->items, *facts)) {
+      return S_FALSE;
+    }
+    if (verb->target == winmenu::verb_target::selection && !facts->background) {
+      winmenu::win32::shell_item_array items(selection);
+      verb->invoke(services, items, launcher);
+      return S_OK;
+    }
+    ComPtr<IShellItem> location;
+    if (GetBestLocationFromSelectionOrSite(selection, &location) != S_OK) {
+      return S_FALSE;
+    }
+    winmenu::win32::shell_item item(location.Get());
+    return verb->invoke(services, item, launcher) != 0 ? S_OK : S_FALSE;
+  }
+  CATCH_RETURN();
+
+  IFACEMETHODIMP GetFlags(_Out_ EXPCMDFLAGS *flags) {
+    auto trace = Trace(winmenu::trace_callback::get_flags);
+    *flags = verb->submenu() ? ECF_HASSUBCOMMANDS : ECF_DEFAULT;
+    return S_OK;
+  }
+  IFACEMETHODIMP EnumSubCommands(_COM_Outptr_ IEnumExplorerCommand **enumCommands);
+
+  // IObjectWithSite
+  IFACEMETHODIMP SetSite(_In_ IUnknown *site) noexcept {
+    m_site = site;
+    // a new site is a new menu
+    m_classifier.reset();
+    m_selection.Reset();
+    m_state.reset();
+    m_decided.Reset();
+    return S_OK;
+  }
+  IFACEMETHODIMP GetSite(_In_ REFIID riid, _COM_Outptr_ void **site) noexcept { return m_site.CopyTo(riid, site); }
+
+private:
+  explicit VerbCommand(const winmenu::verb_descriptor *verb_) : verb(verb_) {}
+  static winmenu::storage_pool<VerbCommand, 16> &Pool() {
+    static winmenu::storage_pool<VerbCommand, 16> pool;
+    return pool;
+  }
+
+  class StateProbe final : public winmenu::state_probe {
+  public:
+    StateProbe(VerbCommand *command_, IShellItemArray *items_) : command(command_), items(items_) {}
+    std::optional<bool> installed_cached() override { return command->verb->installed_cached(services); }
+    bool installed() override { return command->verb->installed(services); }
+    std::optional<winmenu::selection_facts> selection() override {
+      auto facts = command->Classify(items);
+      if (facts && !winmenu::verb_applies(command->verb->items, *facts)) {
+        return std::nullopt;
+      }
+      return facts;
+    }
+    void hold() override { command->m_decided = items; }
+
+  private:
+    VerbCommand *command{nullptr};
+    IShellItemArray *items{nullptr};
+  };
+
+  // Classify fetches the attributes of the selection, or of the folder behind the view when nothing is selected, once
+  // per menu. GetState and Invoke share the result.
+  std::optional<winmenu::selection_facts> Classify(IShellItemArray *selection) {
+    DWORD count = 0;
+    if (selection != nullptr && selection->GetCount(&count) == S_OK && count != 0) {
+      winmenu::win32::shell_item_array items(selection);
+      return m_classifier.classify(selection, items, [&] { m_selection = selection; });
+    }
+    // the site does not change for the lifetime of the menu, its folder is looked up once and cached under the empty
+    // selection
+    ComPtr<IShellItem> psi;
+    winmenu::win32::shell_item item(nullptr);
+    auto facts = m_classifier.classify(nullptr, item, [&] {
+      if (GetLocationFromSite(&psi) == S_OK) {
+        item = winmenu::win32::shell_item(psi.Get());
+      }
+    });
+    if (facts) {
+      facts->background = true;
+    }
+    return facts;
+  }
+
+  HRESULT GetLocationFromSite(IShellItem **location) const noexcept {
+    ComPtr<IServiceProvider> serviceProvider;
+    if (m_site.As(&serviceProvider) != S_OK) {
+      return S_FALSE;
+    }
+    ComPtr<IFolderView> folderView;
+    if (serviceProvider->QueryService(SID_SFolderView, folderView.GetAddressOf()) != S_OK) {
+      return S_FALSE;
+    }
+    return folderView->GetFolder(IID_PPV_ARGS(location));
+  }
+
+  HRESULT GetBestLocationFromSelectionOrSite(IShellItemArray *psiArray, IShellItem **location) const noexcept {
+    ComPtr<IShellItem> psi;
+    if (psiArray) {
+      DWORD count{};
+      if (psiArray->GetCount(&count) != S_OK) {
+        return S_FALSE;
+      }
+      // Sometimes we get an array with a count of 0. Fall back to the site chain.
+      if (count != 0 && psiArray->GetItemAt(0, &psi) != S_OK) {
+        return S_FALSE;
+      }
+    }
+    if (!psi && GetLocationFromSite(&psi) != S_OK) {
+      return S_FALSE;
+    }
+    if (!psi) {
+      return S_FALSE;
+    }
+    return psi.CopyTo(location);
+  }
+
+  const winmenu::verb_descriptor *verb{nullptr};
+  ComPtr<IUnknown> m_site;
+  ComPtr<IShellItemArray> m_selection; // keeps the classified selection alive
+  ComPtr<IShellItemArray> m_decided;   // keeps the selection of the cached GetState decision alive
+  winmenu::selection_classifier m_classifier;
+  winmenu::verb_state_machine m_state;
+};
+
+// SubCommands enumerates the children of a submenu row. Nothing is built up front: Next creates the commands it
+// returns and hands them the site of the menu. Pooled like VerbCommand, built only by Create.
+class SubCommands final : public RuntimeClass<RuntimeClassFlags<ClassicCom | InhibitFtmBase>, IEnumExplorerCommand> {
+public:
+  static ComPtr<SubCommands> Create(const winmenu::submenu_cursor &cursor, IUnknown *site) {
+    ComPtr<SubCommands> commands;
+    commands.Attach(new (std::nothrow) SubCommands(cursor, site));
+    return commands;
+  }
+  static void *operator new(size_t, const std::nothrow_t &) noexcept { return PoolAllocate(Pool()); }
+  static void operator delete(void *p, const std::nothrow_t &) noexcept { Pool().deallocate(p); }
+  static void operator delete(void *p) noexcept { Pool().deallocate(p); }
+
+  IFACEMETHODIMP Next(ULONG celt, _Out_writes_to_(celt, *fetched) IExplorerCommand **commands,
+                      _Out_opt_ ULONG *fetched) {
+    ULONG n = 0;
+    const winmenu::verb_descriptor *child = nullptr;
+    for (; n < celt && cursor.next({&child, 1}) == 1; n++) {
+      auto command = VerbCommand::Create(child, site.Get());
+      if (!command) {
+        for (ULONG i = 0; i < n; i++) {
+          commands[i]->Release();
+          commands[i] = nullptr;
+        }
+        if (fetched != nullptr) {
+          *fetched = 0;
+        }
+        return E_OUTOFMEMORY;
+      }
+      commands[n] = command.Detach();
+    }
+    if (fetched != nullptr) {
+      *fetched = n;
+    }
+    return n == celt ? S_OK : S_FALSE;
+  }
+  IFACEMETHODIMP Skip(ULONG celt) { return cursor.skip(celt) ? S_OK : S_FALSE; }
+  IFACEMETHODIMP Reset() {
+    cursor.reset();
+    return S_OK;
+  }
+  IFACEMETHODIMP Clone(_COM_Outptr_ IEnumExplorerCommand **enumCommands) {
+    *enumCommands = nullptr;
+    auto clone = Create(cursor, site.Get());
+    if (!clone) {
+      return E_OUTOFMEMORY;
+    }
+    *enumCommands = clone.Detach();
+    return S_OK;
+  }
+
+private:
+  SubCommands(const winmenu::submenu_cursor &cursor_, IUnknown *site_) : cursor(cursor_), site(site_) {}
+  static winmenu::storage_pool<SubCommands, 4> &Pool() {
+    static winmenu::storage_pool<SubCommands, 4> pool;
+    return pool;
+  }
+  winmenu::submenu_cursor cursor;
+  ComPtr<IUnknown> site;
+};
+
+IFACEMETHODIMP VerbCommand::EnumSubCommands(_COM_Outptr_ IEnumExplorerCommand **enumCommands) {
+  auto trace = Trace(winmenu::trace_callback::enum_sub_commands);
+  *enumCommands = nullptr;
+  if (!verb->submenu()) {
+    return E_NOTIMPL;
+  }
+  auto children = SubCommands::Create(winmenu::submenu_cursor(*verb), m_site.Get());
+  if (!children) {
+    return E_OUTOFMEMORY;
+  }
+  *enumCommands = children.Detach();
+  return S_OK;
+}
+
+// VerbClassFactory creates the VerbCommand of the row DllGetClassObject found. Explorer asks for a class object for
+// nearly every menu, factories are pooled like the commands they create and built only by Create.
+class VerbClassFactory final : public ClassFactory<> {
+public:
+  static ComPtr<VerbClassFactory> Create(const winmenu::verb_descriptor *verb) {
+    ComPtr<VerbClassFactory> factory;
+    factory.Attach(new (std::nothrow) VerbClassFactory(verb));
+    return factory;
+  }
+  static void *operator new(size_t, const std::nothrow_t &) noexcept { return PoolAllocate(Pool()); }
+  static void operator delete(void *p, const std::nothrow_t &) noexcept { Pool().deallocate(p); }
+  static void operator delete(void *p) noexcept { Pool().deallocate(p); }
+  IFACEMETHODIMP CreateInstance(_In_opt_ IUnknown *outer, _In_ REFIID riid, _COM_Outptr_ void **object) noexcept {
+    *object = nullptr;
+    if (outer != nullptr) {
+      return CLASS_E_NOAGGREGATION;
+    }
+    auto command = VerbCommand::Create(verb, nullptr);
+    if (!command) {
+      return E_OUTOFMEMORY;
+    }
+    return command.CopyTo(riid, object);
+  }
+
+private:
+  explicit VerbClassFactory(const winmenu::verb_descriptor *verb_) : verb(verb_) {}
+  static winmenu::storage_pool<VerbClassFactory, 4> &Pool() {
+    static winmenu::storage_pool<VerbClassFactory, 4> pool;
+    return pool;
+  }
+  const winmenu::verb_descriptor *verb{nullptr};
+};
+
+STDAPI DllCanUnloadNow() { return Module<InProc>::GetModule().GetObjectCount() == 0 ? S_OK : S_FALSE; }
+
+STDAPI DllGetClassObject(_In_ REFCLSID rclsid, _In_ REFIID riid, _COM_Outptr_ void **instance) {
+  *instance = nullptr;
+  auto verb = winmenu::find_verb(winmenu::win32::from_guid(rclsid));
+  if (verb == nullptr) {
+    return CLASS_E_CLASSNOTAVAILABLE;
+  }
+  auto factory = VerbClassFactory::Create(verb);
+  if (!factory) {
+    return E_OUTOFMEMORY;
+  }
+  return factory.CopyTo(riid, instance);
+}
@@ -1,6 +1,7 @@
 #ifndef BELA_ERROR_CODE_HPP
 #define BELA_ERROR_CODE_HPP
 #pragma once
+#if defined(_WIN32)
 #include <SDKDDKVer.h>
 #ifndef _WINDOWS_
 #ifndef WIN32_LEAN_AND_MEAN
@@ -8,14 +9,26 @@
 #endif
 #include <windows.h>
 #endif
+#include <format>
+#endif
 #include <string>
+#include <string_view>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <mutex>
+#include <unordered_map>
 #include <system_error>
 #include <compare>
-#include <format>
+#include <utility>
 
 namespace bela {
 constexpr long ErrNone = 0;
+#if defined(_WIN32)
 constexpr long ErrEOF = ERROR_HANDLE_EOF;
+#else
+constexpr long ErrEOF = 0x4006; // there is no ERROR_HANDLE_EOF to borrow, a bela code that no errno collides with
+#endif
 constexpr long ErrGeneral = 0x4001;
 constexpr long ErrSkipParse = 0x4002;
 constexpr long ErrParseBroken = 0x4003;
@@ -24,24 +37,180 @@ constexpr long ErrFileAlreadyOpened = 0x4005;
 constexpr long ErrEnded = 654320;
 constexpr long ErrCanceled = 654321;
 constexpr long ErrUnimplemented = 654322; // feature not implemented
+#if defined(_WIN32)
+// resolve_system_error_message formats a Windows error code with FormatMessageW
+inline std::wstring resolve_system_error_message(long ec) {
+  LPWSTR buf = nullptr;
+  auto rl = FormatMessageW(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_ALLOCATE_BUFFER, nullptr, static_cast<DWORD>(ec),
+                           MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPWSTR)&buf, 0, nullptr);
+  if (rl == 0) {
+    return std::format(L"GetLastError={:#08x}", static_cast<DWORD>(ec));
+  }
+  auto closer = std::unique_ptr<wchar_t, decltype(&LocalFree)>(buf, &LocalFree);
+  if (buf[rl - 1] == '\n') {
+    rl--;
+  }
+  if (rl > 0 && buf[rl - 1] == '\r') {
+    rl--;
+  }
+  return std::wstring(buf, rl);
+}
+#else
+// resolve_system_error_message formats an errno value, the messages of the C library are ASCII
+inline std::wstring resolve_system_error_message(long ec) {
+  auto msg = std::generic_category().message(static_cast<int>(ec));
+  return std::wstring(msg.begin(), msg.end());
+}
+#endif
+
+// system_error_message returns the message of a system error code. Messages are formatted once per process and
+// shared afterwards, the cache keeps at most 256 of them.
+inline std::shared_ptr<const std::wstring> system_error_message(long ec) {
+  static std::mutex mu;
+  static std::unordered_map<long, std::shared_ptr<const std::wstring>> cache;
+  {
+    std::lock_guard lock(mu);
+    if (auto it = cache.find(ec); it != cache.end()) {
+      return it->second;
+    }
+  }
+  auto msg = std::make_shared<const std::wstring>(resolve_system_error_message(ec));
+  std::lock_guard lock(mu);
+  if (cache.size() < 256) {
+    cache.emplace(ec, msg);
+  }
+  return msg;
+}
+
+// error_message is the text of a bela::error_code. It reads like the std::wstring member error_code used to have
+// (ec.message, ec.message.data(), ec.message = L"...") and like an accessor (ec.message()). The message of an error
+// made from a system code only holds the code until it is first read, then the text comes from the shared
+// system_error_message cache; failing costs no allocation when nobody looks at the message. Several threads may read
+// the same message, it is rendered once.
+class error_message {
+public:
+  error_message() noexcept = default;
+  explicit error_message(std::wstring_view s) noexcept { assign(s); }
+  explicit error_message(std::wstring &&s) noexcept { assign(std::move(s)); }
+  error_message(const error_message &o) noexcept : text(o.text), code(o.code), pending(o.pending) {}
+  error_message(error_message &&o) noexcept { take(o); }
+  error_message &operator=(const error_message &o) noexcept {
+    if (this != &o) {
+      text = o.text;
+      code = o.code;
+      pending = o.pending;
+      restart();
+    }
+    return *this;
+  }
+  error_message &operator=(error_message &&o) noexcept {
+    if (this != &o) {
+      take(o);
+    }
+    return *this;
+  }
+  error_message &operator=(std::wstring_view s) noexcept { return assign(s); }
+  error_message &operator=(std::wstring &&s) noexcept { return assign(std::move(s)); }
+  error_message &operator=(const wchar_t *s) noexcept { return assign(std::wstring_view(s)); }
+  // from_system is the system message of code_ after prefix_, rendered on first read. Without memory for the prefix
+  // the message is the system message alone.
+  [[nodiscard]] static error_message from_system(long code_, std::wstring_view prefix_ = {}) noexcept {
+    error_message m;
+    if (!prefix_.empty()) {
+      m.assign(prefix_);
+    }
+    m.code = code_;
+    m.pending = true;
+    return m;
+  }
+  void clear() noexcept {
+    text.reset();
+    pending = false;
+    restart();
+  }
+  [[nodiscard]] const std::wstring &str() const {
+    static const std::wstring empty;
+    if (!pending) {
+      return text ? *text : empty;
+    }
+    if (!ready.load(std::memory_order_acquire)) {
+      // rendering is rare, every message shares one lock. A rendering that throws leaves ready unset, the next read
+      // tries again.
+      static std::mutex mu;
+      std::lock_guard lock(mu);
+      if (!ready.load(std::memory_order_relaxed)) {
+        auto sys = system_error_message(code);
+        rendered = text ? std::make_shared<const std::wstring>(*text + *sys) : std::move(sys);
+        ready.store(true, std::memory_order_release);
+      }
+    }
+    return *rendered;
+  }
+  [[nodiscard]] const std::wstring &operator()() const { return str(); }
+  operator const std::wstring &() const { return str(); }
+  operator std::wstring_view() const { return str(); }
+  [[nodiscard]] const wchar_t *data() const { return str().data(); }
+  [[nodiscard]] const wchar_t *c_str() const { return str().c_str(); }
+  [[nodiscard]] size_t size() const { return str().size(); }
+  [[nodiscard]] bool empty() const { return str().empty(); }
+  [[nodiscard]] friend bool operator==(const error_message &_Left, std::wstring_view _Right) {
+    return _Left.str() == _Right;
+  }
+
+private:
+  // assign stores a custom message, an error without memory for it has an empty message
+  template <typename S> error_message &assign(S &&s) noexcept {
+    try {
+      text = std::make_shared<const std::wstring>(std::forward<S>(s));
+    } catch (const std::bad_alloc &) {
+      text.reset();
+    }
+    pending = false;
+    restart();
+    return *this;
+  }
+  // take moves o here, a message o already rendered becomes the text
+  void take(error_message &o) noexcept {
+    pending = !o.rendered && o.pending;
+    text = o.rendered ? std::move(o.rendered) : std::move(o.text);
+    code = o.code;
+    restart();
+    o.text.reset();
+    o.pending = false;
+    o.restart();
+  }
+  // restart forgets the rendered message, nobody may read this error meanwhile
+  void restart() noexcept {
+    rendered.reset();
+    ready.store(false, std::memory_order_relaxed);
+  }
+  // text is the message, or the prefix of the system message of code while pending
+  std::shared_ptr<const std::wstring> text;
+  mutable std::shared_ptr<const std::wstring> rendered;
+  mutable std::atomic_bool ready{false};
+  long code{0};
+  bool pending{false};
+};
+
 // bela::error_code is a platform-dependent error code
 struct error_code {
-  std::wstring message;
+  error_message message;
   long code{ErrNone};
   // -----------
   error_code() noexcept = default;
-  error_code(std::wstring &&message_, long code_) noexcept {
-    message = std::move(message_);
-    code = code_;
-  }
-  error_code(std::wstring_view message_, long code_) noexcept {
-    message = message_;
-    code = code_;
-  }
+  error_code(std::wstring &&message_, long code_) noexcept : message(std::move(message_)), code(code_) {}
+  error_code(std::wstring_view message_, long code_) noexcept : message(message_), code(code_) {}
   error_code(const error_code &) = default;
   error_code &operator=(const error_code &) = default;
   error_code(error_code &&) = default;
   error_code &operator=(error_code &&) = default;
+  // from_system makes an error whose message is the system message of code_, after prefix_ when it is not empty
+  [[nodiscard]] static error_code from_system(long code_, std::wstring_view prefix_ = {}) noexcept {
+    error_code ec;
+    ec.message = error_message::from_system(code_, prefix_);
+    ec.code = code_;
+    return ec;
+  }
   error_code &assgin(error_code &&o) {
     *this = std::move(o);
     return *this;
@@ -50,7 +219,7 @@ struct error_code {
     code = ErrNone;
     message.clear();
   }
-  [[nodiscard]] const std::wstring &native() const { return message; }
+  [[nodiscard]] const std::wstring &native() const { return message.str(); }
   [[nodiscard]] const wchar_t *data() const { return message.data(); }
   [[nodiscard]] explicit operator bool() const noexcept { return code != ErrNone; }
   [[nodiscard]] friend bool operator==(const error_code &_Left, const error_code &_Right) noexcept {
@@ -67,32 +236,16 @@ struct error_code {
   }
 };
 
-inline std::wstring resolve_system_error_message(DWORD ec, std::wstring_view prefix) {
-  LPWSTR buf = nullptr;
-  auto rl = FormatMessageW(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_ALLOCATE_BUFFER, nullptr, ec,
-                           MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPWSTR)&buf, 0, nullptr);
-  if (rl == 0) {
-    return std::format(L"{}GetLastError={:#08x}", prefix, ec);
-  }
-  if (buf[rl - 1] == '\n') {
-    rl--;
-  }
-  if (rl > 0 && buf[rl - 1] == '\r') {
-    rl--;
-  }
-  auto msg = std::format(L"{}{}", prefix, std::wstring_view(buf, rl));
-  LocalFree(buf);
-  return msg;
-}
-
-// make_error_code_from_system convert from Windows error code convert to error_code
-[[nodiscard]] inline error_code make_error_code_from_system(DWORD e, std::wstring_view prefix) {
-  return error_code{resolve_system_error_message(e, prefix), static_cast<long>(e)};
+// make_error_code_from_system convert from system error code convert to error_code, the message is rendered lazily
+[[nodiscard]] inline error_code make_error_code_from_system(long e, std::wstring_view prefix = {}) noexcept {
+  return error_code::from_system(e, prefix);
 }
+#if defined(_WIN32)
 // make_system_error_code call GetLastError get error code convert to error_code
-[[nodiscard]] inline error_code make_system_error_code(std::wstring_view prefix = L"") {
-  return make_error_code_from_system(GetLastError(), prefix);
+[[nodiscard]] inline error_code make_system_error_code(std::wstring_view prefix = L"") noexcept {
+  return make_error_code_from_system(static_cast<long>(GetLastError()), prefix);
 }
+#endif
 
 template <class F> class final_act {
 public:
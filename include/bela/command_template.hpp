@@ -0,0 +1,288 @@
+// Shell command template
+#ifndef BELA_COMMAND_TEMPLATE_HPP
+#define BELA_COMMAND_TEMPLATE_HPP
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include "escape_argv.hpp"
+
+namespace bela {
+
+// basic_command_template compiles a shell verb command such as "C:\...\Code.exe" "%1" once and renders it for
+// every selected item. Compile resolves %NAME% environment references; Render substitutes the placeholders:
+//   %1 %L %V  the item path (%0 is an alias of %1, %2 ... %9 render empty)
+//   %W        the working directory
+//   %*        every selected item, escaped and separated by spaces
+// Render computes the exact output size first, rendering into a string with enough capacity does not allocate.
+template <typename charT>
+requires bela::character<charT>
+class basic_command_template {
+public:
+  using string_view_t = std::basic_string_view<charT>;
+  using string_t = std::basic_string<charT>;
+  enum class token_kind : unsigned char { literal, item, directory, items, empty };
+  struct token {
+    token_kind kind{token_kind::literal};
+    size_t offset{0}; // literal range in storage
+    size_t length{0};
+  };
+  struct context {
+    string_view_t item;
+    string_view_t directory;
+    std::span<const string_view_t> items;
+  };
+  basic_command_template() = default;
+  basic_command_template(const basic_command_template &) = default;
+  basic_command_template &operator=(const basic_command_template &) = default;
+  basic_command_template(basic_command_template &&) = default;
+  basic_command_template &operator=(basic_command_template &&) = default;
+
+  // Compile parses text. resolver(string_view_t name, string_t &out) appends the value of an environment variable and
+  // returns false when it is not defined, in which case the reference is kept as is.
+  template <typename Resolver> basic_command_template &Compile(string_view_t text, Resolver &&resolver) {
+    storage.clear();
+    tokens.clear();
+    storage.reserve(text.size());
+    size_t i = 0;
+    while (i < text.size()) {
+      auto pos = text.find('%', i);
+      if (pos == string_view_t::npos) {
+        append_literal(text.substr(i));
+        break;
+      }
+      append_literal(text.substr(i, pos - i));
+      i = pos + 1;
+      if (auto name = environment_name(text, pos); !name.empty()) {
+        auto offset = storage.size();
+        if (!resolver(name, storage)) {
+          storage.resize(offset);
+          storage += '%';
+          storage.append(name);
+          storage += '%';
+        }
+        extend_literal(offset);
+        i = pos + name.size() + 2;
+        continue;
+      }
+      if (i < text.size()) {
+        if (auto kind = placeholder_kind(text[i]); kind != token_kind::literal) {
+          tokens.emplace_back(token{kind, 0, 0});
+          i++;
+          continue;
+        }
+      }
+      append_literal(text.substr(pos, 1));
+    }
+    return *this;
+  }
+  basic_command_template &Compile(string_view_t text) {
+    return Compile(text, [](string_view_t, string_t &) { return false; });
+  }
+  // HasItem reports whether the template consumes the item path
+  [[nodiscard]] bool HasItem() const {
+    for (const auto &t : tokens) {
+      if (t.kind == token_kind::item || t.kind == token_kind::items) {
+        return true;
+      }
+    }
+    return false;
+  }
+  [[nodiscard]] bool empty() const { return tokens.empty(); }
+  [[nodiscard]] std::span<const token> Tokens() const { return tokens; }
+
+  [[nodiscard]] size_t RenderedSize(const context &ctx) const { return rendered_size(ctx, 0, tokens.size()); }
+  // Render replaces out with the rendered command line
+  void Render(const context &ctx, string_t &out) const {
+    out.clear();
+    out.reserve(RenderedSize(ctx));
+    render(ctx, 0, tokens.size(), out);
+  }
+  // RenderParts renders the command before and after its item placeholder (%1 %L %V or %*), dropping the quotes and
+  // blanks around it, so items can be escaped and inserted between them. Returns false unless the template has exactly
+  // one item placeholder and it is a whole argument, bounded by blanks or the ends of the command and optionally
+  // wrapped in one pair of quotes: without one there is nowhere to insert the items, with several every one would need
+  // them, and items escaped into part of an argument (--file=%1, "%1\sub") would split it. Render each item instead;
+  // prefix and suffix are left empty when the placeholder is not a whole argument.
+  bool RenderParts(const context &ctx, string_t &prefix, string_t &suffix) const {
+    auto pos = tokens.size();
+    for (size_t i = 0; i < tokens.size(); i++) {
+      if (tokens[i].kind != token_kind::item && tokens[i].kind != token_kind::items) {
+        continue;
+      }
+      if (pos != tokens.size()) {
+        return false;
+      }
+      pos = i;
+    }
+    if (pos == tokens.size()) {
+      return false;
+    }
+    prefix.clear();
+    prefix.reserve(rendered_size(ctx, 0, pos));
+    render(ctx, 0, pos, prefix);
+    suffix.clear();
+    suffix.reserve(rendered_size(ctx, pos + 1, tokens.size()));
+    render(ctx, pos + 1, tokens.size(), suffix);
+    if (!prefix.empty() && prefix.back() == '"' && !suffix.empty() && suffix.front() == '"') {
+      prefix.pop_back();
+      suffix.erase(0, 1);
+    }
+    if (!ends_blank(prefix) || !starts_blank(suffix) || inside_quotes(prefix)) {
+      prefix.clear();
+      suffix.clear();
+      return false;
+    }
+    while (!prefix.empty() && is_blank(prefix.back())) {
+      prefix.pop_back();
+    }
+    size_t blanks = 0;
+    while (blanks < suffix.size() && is_blank(suffix[blanks])) {
+      blanks++;
+    }
+    suffix.erase(0, blanks);
+    return true;
+  }
+
+private:
+  static constexpr bool is_name_char(charT c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '(' ||
+           c == ')' || c == '.' || c == '-';
+  }
+  // environment_name returns NAME when text[pos] starts a %NAME% reference. %L% and friends are placeholders.
+  static string_view_t environment_name(string_view_t text, size_t pos) {
+    size_t end = pos + 1;
+    while (end < text.size() && is_name_char(text[end])) {
+      end++;
+    }
+    if (end >= text.size() || text[end] != '%' || end == pos + 1) {
+      return {};
+    }
+    if (end == pos + 2 && placeholder_kind(text[pos + 1]) != token_kind::literal) {
+      return {};
+    }
+    return text.substr(pos + 1, end - pos - 1);
+  }
+  static constexpr bool is_blank(charT c) { return c == ' ' || c == '\t'; }
+  // ends_blank and starts_blank report whether an argument boundary is at that end of part
+  static bool ends_blank(const string_t &part) { return part.empty() || is_blank(part.back()); }
+  static bool starts_blank(const string_t &part) { return part.empty() || is_blank(part.front()); }
+  // inside_quotes reports whether text leaves a quoted argument open, following the CommandLineToArgvW rules: a quote
+  // preceded by an odd number of backslashes is literal
+  static bool inside_quotes(string_view_t text) {
+    bool quoted = false;
+    size_t backslashes = 0;
+    for (auto c : text) {
+      if (c == '\\') {
+        backslashes++;
+        continue;
+      }
+      if (c == '"' && backslashes % 2 == 0) {
+        quoted = !quoted;
+      }
+      backslashes = 0;
+    }
+    return quoted;
+  }
+  static constexpr token_kind placeholder_kind(charT c) {
+    switch (c) {
+    case '0':
+    case '1':
+    case 'L':
+    case 'l':
+    case 'V':
+    case 'v':
+      return token_kind::item;
+    case 'W':
+    case 'w':
+      return token_kind::directory;
+    case '*':
+      return token_kind::items;
+    default:
+      break;
+    }
+    if (c >= '2' && c <= '9') {
+      return token_kind::empty;
+    }
+    return token_kind::literal;
+  }
+  void extend_literal(size_t offset) {
+    if (storage.size() == offset) {
+      return;
+    }
+    if (!tokens.empty() && tokens.back().kind == token_kind::literal &&
+        tokens.back().offset + tokens.back().length == offset) {
+      tokens.back().length += storage.size() - offset;
+      return;
+    }
+    tokens.emplace_back(token{token_kind::literal, offset, storage.size() - offset});
+  }
+  void append_literal(string_view_t sv) {
+    auto offset = storage.size();
+    storage.append(sv);
+    extend_literal(offset);
+  }
+  size_t rendered_size(const context &ctx, size_t first, size_t last) const {
+    size_t n = 0;
+    for (auto i = first; i < last; i++) {
+      const auto &t = tokens[i];
+      switch (t.kind) {
+      case token_kind::literal:
+        n += t.length;
+        break;
+      case token_kind::item:
+        n += ctx.item.size();
+        break;
+      case token_kind::directory:
+        n += ctx.directory.size();
+        break;
+      case token_kind::items:
+        for (const auto &it : ctx.items) {
+          n += argv_internal::escaped_size(it) + 1;
+        }
+        if (!ctx.items.empty()) {
+          n--;
+        }
+        break;
+      default:
+        break;
+      }
+    }
+    return n;
+  }
+  void render(const context &ctx, size_t first, size_t last, string_t &out) const {
+    for (auto i = first; i < last; i++) {
+      const auto &t = tokens[i];
+      switch (t.kind) {
+      case token_kind::literal:
+        out.append(storage, t.offset, t.length);
+        break;
+      case token_kind::item:
+        out.append(ctx.item);
+        break;
+      case token_kind::directory:
+        out.append(ctx.directory);
+        break;
+      case token_kind::items:
+        for (size_t j = 0; j < ctx.items.size(); j++) {
+          if (j != 0) {
+            out += ' ';
+          }
+          auto offset = out.size();
+          out.append(argv_internal::escaped_size(ctx.items[j]), '\0');
+          argv_internal::escape_to(ctx.items[j], out.data() + offset);
+        }
+        break;
+      default:
+        break;
+      }
+    }
+  }
+  string_t storage;
+  std::vector<token> tokens;
+};
+
+using command_template = basic_command_template<wchar_t>;
+} // namespace bela
+
+#endif
@@ -1,9 +1,21 @@
 // Escape Argv
 #ifndef BELA_ESCAPE_ARGV_HPP
 #define BELA_ESCAPE_ARGV_HPP
+#include <string>
 #include <string_view>
+#include <algorithm>
 #include <vector>
 #include <span>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BELA_ESCAPE_ARGV_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BELA_ESCAPE_ARGV_SSE2 1
+#endif
 
 namespace bela {
 
@@ -30,7 +42,7 @@ namespace argv_internal {
     static constexpr std::wstring_view Empty = L"\"\"";
 #else
     // libstdc++ call wcslen is bad
-    static constexpr std::wstring_view Empty{L"\"\"", sizeof("\"\"")};
+    static constexpr std::wstring_view Empty{L"\"\"", sizeof("\"\"") - 1};
 #endif
   };
   template <> class Literal<char16_t> {
@@ -42,8 +54,493 @@ namespace argv_internal {
     static constexpr std::u8string_view Empty = u8"\"\"";
   };
 
+  // escape_class summarizes an argument: quotes and backslashes (specials) must be escaped, blanks must be quoted.
+  // Backslashes only matter in front of a quote, an argument without quotes is copied in one piece.
+  struct escape_class {
+    size_t specials{0};
+    size_t quotes{0};
+    bool hasspace{false};
+  };
+
+  template <typename charT> constexpr escape_class classify_scalar(const charT *p, size_t n) {
+    escape_class ec;
+    for (size_t i = 0; i < n; i++) {
+      switch (p[i]) {
+      case '"':
+        ec.quotes++;
+        [[fallthrough]];
+      case '\\':
+        ec.specials++;
+        break;
+      case ' ':
+        [[fallthrough]];
+      case '\t':
+        ec.hasspace = true;
+        break;
+      default:
+        break;
+      }
+    }
+    return ec;
+  }
+  template <typename charT> constexpr size_t find_quote_scalar(const charT *p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      if (p[i] == '"') {
+        return i;
+      }
+    }
+    return n;
+  }
+
+#if defined(BELA_ESCAPE_ARGV_AVX2) || defined(BELA_ESCAPE_ARGV_SSE2)
+  // Vector classification: every lane is compared against '"' '\\' ' ' '\t'. Matches are counted per lane by
+  // subtracting the all-ones compare results, movemask yields sizeof(charT) bits per character, so positions are
+  // divided by the character width.
+#if defined(BELA_ESCAPE_ARGV_AVX2)
+  using simd_t = __m256i;
+  inline simd_t simd_load(const void *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+  inline simd_t simd_or(simd_t a, simd_t b) { return _mm256_or_si256(a, b); }
+  inline unsigned simd_mask(simd_t a) { return static_cast<unsigned>(_mm256_movemask_epi8(a)); }
+  inline simd_t simd_zero() { return _mm256_setzero_si256(); }
+  inline void simd_store(void *p, simd_t a) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a); }
+  template <typename charT> inline simd_t simd_sub(simd_t a, simd_t b) {
+    if constexpr (sizeof(charT) == 1) {
+      return _mm256_sub_epi8(a, b);
+    } else if constexpr (sizeof(charT) == 2) {
+      return _mm256_sub_epi16(a, b);
+    } else {
+      return _mm256_sub_epi32(a, b);
+    }
+  }
+  template <typename charT> inline simd_t simd_splat(charT c) {
+    if constexpr (sizeof(charT) == 1) {
+      return _mm256_set1_epi8(static_cast<char>(c));
+    } else if constexpr (sizeof(charT) == 2) {
+      return _mm256_set1_epi16(static_cast<short>(c));
+    } else {
+      return _mm256_set1_epi32(static_cast<int>(c));
+    }
+  }
+  template <typename charT> inline simd_t simd_eq(simd_t a, simd_t b) {
+    if constexpr (sizeof(charT) == 1) {
+      return _mm256_cmpeq_epi8(a, b);
+    } else if constexpr (sizeof(charT) == 2) {
+      return _mm256_cmpeq_epi16(a, b);
+    } else {
+      return _mm256_cmpeq_epi32(a, b);
+    }
+  }
+#else
+  using simd_t = __m128i;
+  inline simd_t simd_load(const void *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+  inline simd_t simd_or(simd_t a, simd_t b) { return _mm_or_si128(a, b); }
+  inline unsigned simd_mask(simd_t a) { return static_cast<unsigned>(_mm_movemask_epi8(a)); }
+  inline simd_t simd_zero() { return _mm_setzero_si128(); }
+  inline void simd_store(void *p, simd_t a) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), a); }
+  template <typename charT> inline simd_t simd_sub(simd_t a, simd_t b) {
+    if constexpr (sizeof(charT) == 1) {
+      return _mm_sub_epi8(a, b);
+    } else if constexpr (sizeof(charT) == 2) {
+      return _mm_sub_epi16(a, b);
+    } else {
+      return _mm_sub_epi32(a, b);
+    }
+  }
+  template <typename charT> inline simd_t simd_splat(charT c) {
+    if constexpr (sizeof(charT) == 1) {
+      return _mm_set1_epi8(static_cast<char>(c));
+    } else if constexpr (sizeof(charT) == 2) {
+      return _mm_set1_epi16(static_cast<short>(c));
+    } else {
+      return _mm_set1_epi32(static_cast<int>(c));
+    }
+  }
+  template <typename charT> inline simd_t simd_eq(simd_t a, simd_t b) {
+    if constexpr (sizeof(charT) == 1) {
+      return _mm_cmpeq_epi8(a, b);
+    } else if constexpr (sizeof(charT) == 2) {
+      return _mm_cmpeq_epi16(a, b);
+    } else {
+      return _mm_cmpeq_epi32(a, b);
+    }
+  }
+#endif
+  template <typename charT> constexpr size_t simd_lanes = sizeof(simd_t) / sizeof(charT);
+
+  // simd_sum adds up the lanes of a vector of per-lane counts
+  template <typename charT> inline size_t simd_sum(simd_t counts) {
+    using lane_t = std::conditional_t<sizeof(charT) == 1, uint8_t,
+                                      std::conditional_t<sizeof(charT) == 2, uint16_t, uint32_t>>;
+    lane_t lanes[simd_lanes<charT>];
+    simd_store(lanes, counts);
+    size_t n = 0;
+    for (auto l : lanes) {
+      n += l;
+    }
+    return n;
+  }
+
+  template <typename charT> inline escape_class classify_simd(const charT *p, size_t n) {
+    const auto quote = simd_splat<charT>('"');
+    const auto slash = simd_splat<charT>('\\');
+    const auto space = simd_splat<charT>(' ');
+    const auto tab = simd_splat<charT>('\t');
+    // a lane counts at most 255 blocks before it is summed, so 8-bit lanes cannot wrap
+    constexpr size_t block = simd_lanes<charT>;
+    constexpr size_t flush = 255 * block;
+    escape_class ec;
+    size_t i = 0;
+    unsigned blanks = 0;
+    while (i + block <= n) {
+      auto specials = simd_zero();
+      auto quotes = simd_zero();
+      auto end = i + std::min(flush, (n - i) / block * block);
+      for (; i < end; i += block) {
+        auto v = simd_load(p + i);
+        auto q = simd_eq<charT>(v, quote);
+        quotes = simd_sub<charT>(quotes, q);
+        specials = simd_sub<charT>(specials, simd_or(q, simd_eq<charT>(v, slash)));
+        blanks |= simd_mask(simd_or(simd_eq<charT>(v, space), simd_eq<charT>(v, tab)));
+      }
+      ec.specials += simd_sum<charT>(specials);
+      ec.quotes += simd_sum<charT>(quotes);
+    }
+    auto tail = classify_scalar(p + i, n - i);
+    ec.specials += tail.specials;
+    ec.quotes += tail.quotes;
+    ec.hasspace = blanks != 0 || tail.hasspace;
+    return ec;
+  }
+  template <typename charT> inline size_t find_quote_simd(const charT *p, size_t n) {
+    const auto quote = simd_splat<charT>('"');
+    size_t i = 0;
+    for (; i + simd_lanes<charT> <= n; i += simd_lanes<charT>) {
+      if (auto m = simd_mask(simd_eq<charT>(simd_load(p + i), quote)); m != 0) {
+        return i + static_cast<size_t>(std::countr_zero(m)) / sizeof(charT);
+      }
+    }
+    return i + find_quote_scalar(p + i, n - i);
+  }
+#endif
+
+  // classify scans an argument once, 16 or 32 bytes at a time when SSE2/AVX2 is available
+  template <typename charT> constexpr escape_class classify(std::basic_string_view<charT> sv) {
+#if defined(BELA_ESCAPE_ARGV_AVX2) || defined(BELA_ESCAPE_ARGV_SSE2)
+    if (!std::is_constant_evaluated()) {
+      return classify_simd(sv.data(), sv.size());
+    }
+#endif
+    return classify_scalar(sv.data(), sv.size());
+  }
+  // find_quote returns the offset of the first quote, sv.size() if none
+  template <typename charT> constexpr size_t find_quote(std::basic_string_view<charT> sv) {
+#if defined(BELA_ESCAPE_ARGV_AVX2) || defined(BELA_ESCAPE_ARGV_SSE2)
+    if (!std::is_constant_evaluated()) {
+      return find_quote_simd(sv.data(), sv.size());
+    }
+#endif
+    return find_quote_scalar(sv.data(), sv.size());
+  }
+
+  // escape_emit calls copy(span) for every span of sv copied verbatim and put(c) for every character it inserts.
+  // Backslashes only need doubling in front of a quote (and of the closing quote), so everything between quotes is
+  // copied in bulk. The caller has checked that sv is not empty and needs escaping.
+  template <typename charT, typename Copy, typename Put>
+  constexpr void escape_emit(std::basic_string_view<charT> sv, const escape_class &ec, Copy &&copy, Put &&put) {
+    auto hasspace = ec.hasspace;
+    if (hasspace) {
+      put('"');
+    }
+    auto rest = sv;
+    if (ec.quotes == 0) {
+      copy(rest);
+      rest = {};
+    }
+    while (!rest.empty()) {
+      auto pos = find_quote(rest);
+      if (pos != 0) {
+        copy(rest.substr(0, pos));
+        if (pos == rest.size()) {
+          break;
+        }
+      }
+      for (auto i = pos; i > 0 && rest[i - 1] == '\\'; i--) {
+        put('\\');
+      }
+      put('\\');
+      put('"');
+      rest.remove_prefix(pos + 1);
+    }
+    if (hasspace) {
+      for (auto i = sv.size(); i > 0 && sv[i - 1] == '\\'; i--) {
+        put('\\');
+      }
+      put('"');
+    }
+  }
+
+  // escaped_size returns the exact length of sv escaped by basic_escape_argv, ec = classify(sv)
+  template <typename charT>
+  constexpr size_t escaped_size(std::basic_string_view<charT> sv, const escape_class &ec) {
+    if (sv.empty()) {
+      return 2;
+    }
+    if (!ec.hasspace && ec.quotes == 0) {
+      return sv.size();
+    }
+    if (ec.quotes == 0) {
+      // only the backslashes in front of the closing quote are doubled
+      size_t n = sv.size() + 2;
+      for (auto i = sv.size(); i > 0 && sv[i - 1] == '\\'; i--) {
+        n++;
+      }
+      return n;
+    }
+    size_t n = 0;
+    escape_emit(
+        sv, ec, [&](std::basic_string_view<charT> span) { n += span.size(); }, [&](charT) { n++; });
+    return n;
+  }
+  template <typename charT> constexpr size_t escaped_size(std::basic_string_view<charT> sv) {
+    return escaped_size(sv, classify(sv));
+  }
+  // escaped_size of args separated by spaces
+  template <typename charT> constexpr size_t escaped_size(std::span<const std::basic_string_view<charT>> args) {
+    size_t n = 0;
+    for (auto a : args) {
+      n += escaped_size(a) + 1;
+    }
+    return args.empty() ? 0 : n - 1;
+  }
+
+  // escape_into writes sv escaped to sink, ec = classify(sv). A sink has write(const charT *, size_t) and put(charT).
+  template <typename charT, typename Sink>
+  constexpr void escape_into(Sink &sink, std::basic_string_view<charT> sv, const escape_class &ec) {
+    if (sv.empty()) {
+      sink.put('"');
+      sink.put('"');
+      return;
+    }
+    if (ec.specials == 0 && !ec.hasspace) {
+      sink.write(sv.data(), sv.size());
+      return;
+    }
+    escape_emit(
+        sv, ec, [&](std::basic_string_view<charT> span) { sink.write(span.data(), span.size()); },
+        [&](charT c) { sink.put(c); });
+  }
+
+  // escape_joined_into writes the argument prefix + value, prefix escapes to itself and does not end with a backslash,
+  // so it sits unchanged inside the quotes of value
+  template <typename charT, typename Sink>
+  constexpr void escape_joined_into(Sink &sink, std::basic_string_view<charT> prefix,
+                                    std::basic_string_view<charT> value) {
+    if (value.empty()) {
+      sink.write(prefix.data(), prefix.size());
+      return;
+    }
+    auto ec = classify(value);
+    if (ec.specials == 0 && !ec.hasspace) {
+      sink.write(prefix.data(), prefix.size());
+      sink.write(value.data(), value.size());
+      return;
+    }
+    if (ec.hasspace) {
+      sink.put('"');
+    }
+    sink.write(prefix.data(), prefix.size());
+    auto body = ec;
+    body.hasspace = false;
+    escape_emit(
+        value, body, [&](std::basic_string_view<charT> span) { sink.write(span.data(), span.size()); },
+        [&](charT c) { sink.put(c); });
+    if (ec.hasspace) {
+      for (auto i = value.size(); i > 0 && value[i - 1] == '\\'; i--) {
+        sink.put('\\');
+      }
+      sink.put('"');
+    }
+  }
+
+  // escape_to writes sv escaped by basic_escape_argv rules to out, which must hold escaped_size(sv) characters
+  template <typename charT>
+  constexpr charT *escape_to(std::basic_string_view<charT> sv, const escape_class &ec, charT *out) {
+    struct {
+      charT *p;
+      constexpr void write(const charT *s, size_t n) { p = std::char_traits<charT>::copy(p, s, n) + n; }
+      constexpr void put(charT c) { *p++ = c; }
+    } sink{out};
+    escape_into(sink, sv, ec);
+    return sink.p;
+  }
+  template <typename charT> constexpr charT *escape_to(std::basic_string_view<charT> sv, charT *out) {
+    return escape_to(sv, classify(sv), out);
+  }
+
+  // literal_text captures a string literal as a template argument
+  template <typename charT, size_t N> struct literal_text {
+    using value_type = charT;
+    charT value[N]{};
+    consteval literal_text(const charT (&s)[N]) {
+      for (size_t i = 0; i < N; i++) {
+        value[i] = s[i];
+      }
+    }
+    constexpr std::basic_string_view<charT> sv() const { return {value, N - 1}; }
+  };
+
 } // namespace argv_internal
 
+// basic_escaped_literal is an argument escaped at compile time, appending it copies N characters without a scan
+template <typename charT, size_t N> struct basic_escaped_literal {
+  using value_type = charT;
+  charT value[N + 1]{};
+  // joinable literals escape to themselves and end without a backslash, they can start an argument completed at
+  // runtime (see basic_escape_argv::AppendJoined)
+  bool joinable{false};
+  constexpr size_t size() const { return N; }
+  constexpr std::basic_string_view<charT> sv() const { return {value, N}; }
+};
+
+// escape_literal escapes a string literal at compile time: constexpr auto reuse = bela::escape_literal<L"-r">();
+template <argv_internal::literal_text S> consteval auto escape_literal() {
+  using charT = typename decltype(S)::value_type;
+  constexpr auto text = S.sv();
+  basic_escaped_literal<charT, argv_internal::escaped_size(text)> e;
+  argv_internal::escape_to(text, e.value);
+  auto ec = argv_internal::classify(text);
+  e.joinable = !text.empty() && ec.quotes == 0 && !ec.hasspace && text.back() != '\\';
+  return e;
+}
+
+// argv_sink is where basic_argv_writer streams a command line: write(p, n) appends n characters, put(c) one
+template <typename Sink, typename charT>
+concept argv_sink = requires(Sink &sink, const charT *p, size_t n, charT c) {
+  sink.write(p, n);
+  sink.put(c);
+};
+
+// basic_string_sink appends to a growable string
+template <typename charT, typename Traits = std::char_traits<charT>, typename Allocator = std::allocator<charT>>
+class basic_string_sink {
+public:
+  using string_t = std::basic_string<charT, Traits, Allocator>;
+  explicit basic_string_sink(string_t &s_) : s(s_) {}
+  void write(const charT *p, size_t n) { s.append(p, n); }
+  void put(charT c) { s.push_back(c); }
+
+private:
+  string_t &s;
+};
+
+// basic_iterator_sink writes through an output iterator, out() is the iterator past the last character
+template <typename charT, typename OutputIt> class basic_iterator_sink {
+public:
+  explicit constexpr basic_iterator_sink(OutputIt it_) : it(it_) {}
+  constexpr void write(const charT *p, size_t n) { it = std::copy_n(p, n, it); }
+  constexpr void put(charT c) { *it++ = c; }
+  constexpr OutputIt out() const { return it; }
+
+private:
+  OutputIt it;
+};
+
+// basic_span_sink fills memory of the caller. Characters that do not fit are dropped and the sink overflows; size()
+// keeps counting, so after an overflow it is the capacity the command line needs.
+template <typename charT> class basic_span_sink {
+public:
+  explicit constexpr basic_span_sink(std::span<charT> buffer_) : buffer(buffer_) {}
+  constexpr void write(const charT *p, size_t n) {
+    if (used < buffer.size()) {
+      std::copy_n(p, std::min(n, buffer.size() - used), buffer.data() + used);
+    }
+    used += n;
+  }
+  constexpr void put(charT c) {
+    if (used < buffer.size()) {
+      buffer[used] = c;
+    }
+    used++;
+  }
+  constexpr size_t size() const { return used; }
+  constexpr bool overflow() const { return used > buffer.size(); }
+  // sv is the command line, cut at the end of the buffer after an overflow
+  constexpr std::basic_string_view<charT> sv() const { return {buffer.data(), std::min(used, buffer.size())}; }
+
+private:
+  std::span<charT> buffer;
+  size_t used{0};
+};
+
+// basic_fixed_buffer_sink is a span sink over N characters of its own, on the stack of the caller. c_str() is null
+// terminated and writable, as CreateProcessW's lpCommandLine must be.
+template <typename charT, size_t N> class basic_fixed_buffer_sink {
+public:
+  constexpr basic_fixed_buffer_sink() = default;
+  basic_fixed_buffer_sink(const basic_fixed_buffer_sink &) = delete;
+  basic_fixed_buffer_sink &operator=(const basic_fixed_buffer_sink &) = delete;
+  constexpr void write(const charT *p, size_t n) { span.write(p, n); }
+  constexpr void put(charT c) { span.put(c); }
+  constexpr size_t size() const { return span.size(); }
+  constexpr bool overflow() const { return span.overflow(); }
+  constexpr std::basic_string_view<charT> sv() const { return span.sv(); }
+  constexpr charT *c_str() {
+    storage[span.sv().size()] = 0;
+    return storage;
+  }
+
+private:
+  // left uninitialized, only the characters written and the terminator c_str() adds are ever read
+  charT storage[N + 1];
+  basic_span_sink<charT> span{std::span<charT>(storage, N)};
+};
+
+// basic_argv_writer escapes arguments into a sink with the rules of basic_escape_argv and never allocates by itself:
+// with a fixed buffer sink the command line is built on the stack, with a string sink reserved to EscapedSize it
+// grows once.
+template <typename charT, typename Sink>
+requires bela::character<charT> && argv_sink<Sink, charT>
+class basic_argv_writer {
+public:
+  using string_view_t = std::basic_string_view<charT>;
+  explicit constexpr basic_argv_writer(Sink &sink_) : sink(sink_) {}
+  basic_argv_writer(const basic_argv_writer &) = delete;
+  basic_argv_writer &operator=(const basic_argv_writer &) = delete;
+  constexpr basic_argv_writer &Append(string_view_t arg) {
+    separate();
+    argv_internal::escape_into(sink, arg, argv_internal::classify(arg));
+    return *this;
+  }
+  constexpr basic_argv_writer &AppendNoEscape(string_view_t arg) {
+    separate();
+    sink.write(arg.data(), arg.size());
+    return *this;
+  }
+  template <size_t N> constexpr basic_argv_writer &Append(const basic_escaped_literal<charT, N> &arg) {
+    return AppendNoEscape(arg.sv());
+  }
+  // AppendJoined appends prefix + value as one argument, see basic_escape_argv::AppendJoined
+  template <auto prefix> constexpr basic_argv_writer &AppendJoined(string_view_t value) {
+    static_assert(std::is_same_v<typename decltype(prefix)::value_type, charT>);
+    static_assert(prefix.joinable, "a prefix must escape to itself and not end with a backslash");
+    separate();
+    argv_internal::escape_joined_into(sink, prefix.sv(), value);
+    return *this;
+  }
+  // EscapedSize returns the exact length of args escaped and separated by spaces
+  static constexpr size_t EscapedSize(std::span<const string_view_t> args) { return argv_internal::escaped_size(args); }
+
+private:
+  constexpr void separate() {
+    if (!first) {
+      sink.put(' ');
+    }
+    first = false;
+  }
+  Sink &sink;
+  bool first{true};
+};
+
 // basic escape argv
 template <typename charT, typename Allocator = std::allocator<charT>>
 requires bela::character<charT>
@@ -61,85 +558,24 @@ public:
   basic_escape_argv &operator=(const basic_escape_argv &) = delete;
   // AssignFull
   basic_escape_argv &AssignFull(const std::span<string_view_t> args) {
-    struct arg_status {
-      unsigned len{0};
-      bool hasspace{false};
-    };
     size_t totalsize = 0;
-    std::vector<arg_status> avs(args.size());
+    std::vector<argv_internal::escape_class> avs(args.size());
     for (size_t i = 0; i < args.size(); i++) {
       auto ac = args[i];
       if (ac.empty()) {
-        avs[i].len = 2; // "\"\""
-        totalsize += 2;
+        totalsize += 2; // "\"\""
         continue;
       }
-      auto n = static_cast<unsigned>(ac.size());
-      for (auto c : ac) {
-        switch (c) {
-        case L'"':
-          [[fallthrough]];
-        case L'\\':
-          n++;
-          break;
-        case ' ':
-          [[fallthrough]];
-        case '\t':
-          avs[i].hasspace = true;
-          break;
-        default:
-          break;
-        }
-      }
-      if (avs[i].hasspace) {
-        n += 2;
-      }
-      avs[i].len = n;
-      totalsize += n;
+      avs[i] = argv_internal::classify(ac);
+      // upper bound: every special may gain a backslash
+      totalsize += ac.size() + avs[i].specials + (avs[i].hasspace ? 2 : 0);
     }
-    saver.reserve(args.size() + totalsize);
+    saver.reserve(saver.size() + args.size() + totalsize);
     for (size_t i = 0; i < args.size(); i++) {
-      auto ac = args[i];
       if (!saver.empty()) {
         saver += ' ';
       }
-      if (ac.empty()) {
-        saver += string_empty_escape;
-        continue;
-      }
-      if (ac.size() == avs[i].len) {
-        saver.append(ac);
-        continue;
-      }
-      if (avs[i].hasspace) {
-        saver += '"';
-      }
-      size_t slashes = 0;
-      for (auto c : ac) {
-        switch (c) {
-        case '\\':
-          slashes++;
-          saver += '\\';
-          break;
-        case '"': {
-          for (; slashes > 0; slashes--) {
-            saver += '\\';
-          }
-          saver += '\\';
-          saver += c;
-        } break;
-        default:
-          slashes = 0;
-          saver += c;
-          break;
-        }
-      }
-      if (avs[i].hasspace) {
-        for (; slashes > 0; slashes--) {
-          saver += '\\';
-        }
-        saver += '"';
-      }
+      append_escaped(args[i], avs[i], saver);
     }
     return *this;
   }
@@ -163,10 +599,59 @@ public:
     argv_escape_internal(aN, saver);
     return *this;
   }
+  // Assign and Append of a literal escaped by escape_literal copy it as is
+  template <size_t N> basic_escape_argv &Assign(const basic_escaped_literal<charT, N> &arg0) {
+    saver.assign(arg0.sv());
+    return *this;
+  }
+  template <size_t N> basic_escape_argv &Append(const basic_escaped_literal<charT, N> &aN) {
+    return AppendNoEscape(aN.sv());
+  }
+  // AppendJoined appends the argument prefix + value, such as --cd=<directory>. The literal is copied as is, only
+  // value is scanned at runtime.
+  template <auto prefix> basic_escape_argv &AppendJoined(string_view_t value) {
+    static_assert(std::is_same_v<typename decltype(prefix)::value_type, charT>);
+    static_assert(prefix.joinable, "a prefix must escape to itself and not end with a backslash");
+    if (!saver.empty()) {
+      saver += ' ';
+    }
+    saver.reserve(saver.size() + prefix.size() + value.size() + 2);
+    basic_string_sink<charT, std::char_traits<charT>, Allocator> sink(saver);
+    argv_internal::escape_joined_into(sink, prefix.sv(), value);
+    return *this;
+  }
+  // EscapedSize returns the exact length of args escaped and separated by spaces
+  static constexpr size_t EscapedSize(std::span<const string_view_t> args) { return argv_internal::escaped_size(args); }
+  // AppendAll escapes borrowed args straight into the command line. The buffer grows once to its exact final size,
+  // every argument is copied exactly once, by escape_to.
+  basic_escape_argv &AppendAll(std::span<const string_view_t> args) { return AppendAll(args, EscapedSize(args)); }
+  // AppendAll with escaped = EscapedSize(args) already known
+  basic_escape_argv &AppendAll(std::span<const string_view_t> args, size_t escaped) {
+    if (args.empty()) {
+      return *this;
+    }
+    auto offset = saver.size();
+    auto n = escaped + (saver.empty() ? 0 : 1);
+    saver.resize(offset + n);
+    auto out = saver.data() + offset;
+    for (auto a : args) {
+      if (out != saver.data()) {
+        *out++ = ' ';
+      }
+      out = argv_internal::escape_to(a, out);
+    }
+    return *this;
+  }
   const charT *data() const { return saver.data(); }
   charT *data() { return saver.data(); }
   string_view_t sv() const { return saver; }
   size_t size() const { return saver.size(); }
+  // Detach hands the null-terminated buffer over, writable as CreateProcessW's lpCommandLine, and leaves this empty
+  string_t Detach() {
+    string_t s(std::move(saver));
+    saver.clear();
+    return s;
+  }
 
 private:
   void argv_escape_internal(string_view_t sv, string_t &s) {
@@ -177,67 +662,21 @@ private:
       s += string_empty_escape;
       return;
     }
-    bool hasspace = false;
-    auto n = sv.size();
-    for (auto c : sv) {
-      switch (c) {
-      case '"':
-        [[fallthrough]];
-      case '\\':
-        n++;
-        break;
-      case ' ':
-        [[fallthrough]];
-      case '\t':
-        hasspace = true;
-        break;
-      default:
-        break;
-      }
-    }
-    if (hasspace) {
-      n += 2;
-    }
-    if (n == sv.size()) {
-      s += sv;
-      return;
-    }
-    s.reserve(s.size() + sv.size() + 1);
-    if (hasspace) {
-      s += '"';
-    }
-    size_t slashes = 0;
-    for (auto c : sv) {
-      switch (c) {
-      case '\\':
-        slashes++;
-        s += '\\';
-        break;
-      case L'"': {
-        for (; slashes > 0; slashes--) {
-          s += '\\';
-        }
-        s += '\\';
-        s += c;
-      } break;
-      default:
-        slashes = 0;
-        s += c;
-        break;
-      }
-    }
-    if (hasspace) {
-      for (; slashes > 0; slashes--) {
-        s += '\\';
-      }
-      s += '"';
-    }
+    auto ec = argv_internal::classify(sv);
+    s.reserve(s.size() + sv.size() + ec.specials + 2);
+    append_escaped(sv, ec, s);
+  }
+  // append_escaped bulk copies the spans without quotes or backslashes
+  static void append_escaped(string_view_t sv, const argv_internal::escape_class &ec, string_t &s) {
+    basic_string_sink<charT, std::char_traits<charT>, Allocator> sink(s);
+    argv_internal::escape_into(sink, sv, ec);
   }
 
   string_t saver;
 };
 
 using EscapeArgv = basic_escape_argv<wchar_t>;
+
 } // namespace bela
 
 #endif
@@ -0,0 +1,208 @@
+// Small buffer paths
+#ifndef BELA_PATH_BUFFER_HPP
+#define BELA_PATH_BUFFER_HPP
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace bela {
+
+namespace path_internal {
+  template <typename charT> constexpr bool is_separator(charT c) { return c == '\\' || c == '/'; }
+#if defined(_WIN32)
+  constexpr char preferred_separator = '\\';
+#else
+  constexpr char preferred_separator = '/';
+#endif
+  // Win32 functions refuse paths of MAX_PATH characters or more unless they carry the \\?\ prefix
+  constexpr size_t max_path = 260;
+} // namespace path_internal
+
+// basic_path_buffer is a null-terminated path that lives in N inline characters and only moves to the heap when it
+// grows longer, which on Windows means \\?\ long paths. Install directories, executables and selection items fit
+// in MAX_PATH, so building one costs no allocation; joins write in place instead of going through temporary
+// std::filesystem::path or std::wstring objects. Join inserts separator, the native one unless told otherwise.
+template <typename charT, size_t N, charT separator = path_internal::preferred_separator> class basic_path_buffer {
+public:
+  using string_view_t = std::basic_string_view<charT>;
+  using traits_type = std::char_traits<charT>;
+  static constexpr size_t inline_capacity = N;
+  static constexpr charT preferred_separator = separator;
+
+  basic_path_buffer() { storage[0] = 0; }
+  explicit basic_path_buffer(string_view_t s) : basic_path_buffer() { Assign(s); }
+  basic_path_buffer(const basic_path_buffer &other) : basic_path_buffer() { Assign(other.sv()); }
+  basic_path_buffer(basic_path_buffer &&other) noexcept : basic_path_buffer() { steal(other); }
+  basic_path_buffer &operator=(const basic_path_buffer &other) {
+    if (this != &other) {
+      Assign(other.sv());
+    }
+    return *this;
+  }
+  basic_path_buffer &operator=(basic_path_buffer &&other) noexcept {
+    if (this != &other) {
+      release();
+      steal(other);
+    }
+    return *this;
+  }
+  ~basic_path_buffer() { release(); }
+
+  const charT *data() const { return ptr; }
+  charT *data() { return ptr; }
+  const charT *c_str() const { return ptr; }
+  size_t size() const { return len; }
+  bool empty() const { return len == 0; }
+  size_t capacity() const { return cap; }
+  // spilled is true once the path has outgrown the inline storage
+  bool spilled() const { return ptr != storage; }
+  string_view_t sv() const { return {ptr, len}; }
+  operator string_view_t() const { return sv(); }
+  std::basic_string<charT> str() const { return std::basic_string<charT>(ptr, len); }
+
+  void Reserve(size_t n) {
+    if (n <= cap) {
+      return;
+    }
+    auto newcap = std::max(n, cap * 2);
+    auto p = new charT[newcap + 1];
+    traits_type::copy(p, ptr, len + 1);
+    release();
+    ptr = p;
+    cap = newcap;
+  }
+  // Assign, Append and Join take views of the buffer itself, such as a prefix of sv()
+  basic_path_buffer &Assign(string_view_t s) {
+    place(0, s);
+    return *this;
+  }
+  // Append adds s as is, no separator
+  basic_path_buffer &Append(string_view_t s) {
+    place(len, s);
+    return *this;
+  }
+  basic_path_buffer &Append(charT c) {
+    Reserve(len + 1);
+    ptr[len++] = c;
+    ptr[len] = 0;
+    return *this;
+  }
+  // Join appends component after exactly one separator: an existing trailing separator is kept, leading separators
+  // of component are dropped. Joining to an empty buffer is Assign.
+  basic_path_buffer &Join(string_view_t component) {
+    if (len == 0) {
+      return Assign(component);
+    }
+    auto skip = std::min(component.find_first_not_of(separators), component.size());
+    component.remove_prefix(skip);
+    auto end = len;
+    if (path_internal::is_separator(ptr[end - 1])) {
+      place(end, component);
+      return *this;
+    }
+    // component is placed first, it may be a view of the characters the separator overwrites
+    place(end + 1, component);
+    ptr[end] = preferred_separator;
+    return *this;
+  }
+  template <typename... Components> basic_path_buffer &Join(string_view_t component, Components... rest) {
+    Join(component);
+    return Join(rest...);
+  }
+  // Truncate shortens the path to n characters, Join after Truncate reuses a common prefix
+  void Truncate(size_t n) {
+    len = std::min(n, len);
+    ptr[len] = 0;
+  }
+  void Clear() { Truncate(0); }
+  // ResizeForOverwrite makes room for n characters and returns the buffer to be filled by a Win32 API, Truncate then
+  // sets the length that was actually written
+  charT *ResizeForOverwrite(size_t n) {
+    Reserve(n);
+    len = n;
+    ptr[len] = 0;
+    return ptr;
+  }
+  // MakeExtended turns a drive or UNC path too long for Win32 functions into its \\?\ form: C:\x becomes \\?\C:\x,
+  // \\server\share becomes \\?\UNC\server\share. The \\?\ form takes no '/' nor relative paths, those are left alone.
+  basic_path_buffer &MakeExtended() {
+    if (len < path_internal::max_path || sv().find('/') != string_view_t::npos) {
+      return *this;
+    }
+    auto drive = len >= 3 && ptr[1] == ':' && ptr[2] == '\\' &&
+                 ((ptr[0] >= 'A' && ptr[0] <= 'Z') || (ptr[0] >= 'a' && ptr[0] <= 'z'));
+    auto unc = ptr[0] == '\\' && ptr[1] == '\\' && ptr[2] != '?' && ptr[2] != '.';
+    if (drive) {
+      return insert_front(long_prefix, 0);
+    }
+    if (unc) {
+      return insert_front(long_unc_prefix, 2);
+    }
+    return *this;
+  }
+
+private:
+  static constexpr charT separators[] = {'\\', '/', 0};
+  static constexpr charT long_prefix[] = {'\\', '\\', '?', '\\', 0};
+  static constexpr charT long_unc_prefix[] = {'\\', '\\', '?', '\\', 'U', 'N', 'C', '\\', 0};
+  // place copies s to pos and ends the path after it. s may point into this buffer: its offset survives a Reserve that
+  // moves the buffer, and the copy is a move since source and destination may overlap.
+  void place(size_t pos, string_view_t s) {
+    auto src = s.data();
+    if (pos + s.size() > cap) {
+      auto aliased = !s.empty() && std::less_equal<const charT *>()(ptr, src) &&
+                     std::less<const charT *>()(src, ptr + cap + 1);
+      auto offset = aliased ? static_cast<size_t>(src - ptr) : 0;
+      Reserve(pos + s.size());
+      if (aliased) {
+        src = ptr + offset;
+      }
+    }
+    traits_type::move(ptr + pos, src, s.size());
+    len = pos + s.size();
+    ptr[len] = 0;
+  }
+  // insert_front replaces the first drop characters with prefix
+  template <size_t M> basic_path_buffer &insert_front(const charT (&prefix)[M], size_t drop) {
+    constexpr auto n = M - 1;
+    Reserve(len + n - drop);
+    traits_type::move(ptr + n, ptr + drop, len - drop + 1);
+    traits_type::copy(ptr, prefix, n);
+    len += n - drop;
+    return *this;
+  }
+  void release() {
+    if (spilled()) {
+      delete[] ptr;
+    }
+    ptr = storage;
+    cap = N;
+  }
+  void steal(basic_path_buffer &other) {
+    if (!other.spilled()) {
+      traits_type::copy(storage, other.storage, other.len + 1);
+      len = other.len;
+      return;
+    }
+    ptr = std::exchange(other.ptr, other.storage);
+    cap = std::exchange(other.cap, N);
+    len = std::exchange(other.len, 0);
+    other.storage[0] = 0;
+  }
+  charT storage[N + 1]; // not cleared, only the terminator matters
+  charT *ptr{storage};
+  size_t len{0};
+  size_t cap{N};
+};
+
+// path_buffer holds MAX_PATH characters inline
+using path_buffer = basic_path_buffer<wchar_t, path_internal::max_path>;
+// windows_path_buffer joins with backslashes on every platform, for Windows paths handled elsewhere
+using windows_path_buffer = basic_path_buffer<wchar_t, path_internal::max_path, L'\\'>;
+
+} // namespace bela
+
+#endif
@@ -0,0 +1,326 @@
+// Case-insensitive paths
+#ifndef BELA_PATH_FOLD_HPP
+#define BELA_PATH_FOLD_HPP
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BELA_PATH_FOLD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BELA_PATH_FOLD_SSE2 1
+#endif
+
+namespace bela {
+
+namespace fold_internal {
+  // upcase_range maps first, first + stride, ... last to code + delta (mod 0x10000)
+  struct upcase_range {
+    char16_t first;
+    char16_t last;
+    uint16_t delta;
+    uint16_t stride;
+  };
+  // Simple uppercase mappings of the BMP above ASCII (Unicode 14), one code unit to one code unit like the upcase
+  // table of NTFS. Characters whose uppercase is ASCII (dotless i, long s) are left alone, the file system keeps
+  // them apart from I and S.
+  inline constexpr upcase_range upcase_ranges[] = {
+    {0x00B5, 0x00B5, 0x02E7, 1}, {0x00E0, 0x00F6, 0xFFE0, 1}, {0x00F8, 0x00FE, 0xFFE0, 1}, {0x00FF, 0x00FF, 0x0079, 1},
+    {0x0101, 0x012F, 0xFFFF, 2}, {0x0133, 0x0137, 0xFFFF, 2}, {0x013A, 0x0148, 0xFFFF, 2}, {0x014B, 0x0177, 0xFFFF, 2},
+    {0x017A, 0x017E, 0xFFFF, 2}, {0x0180, 0x0180, 0x00C3, 1}, {0x0183, 0x0185, 0xFFFF, 2}, {0x0188, 0x0188, 0xFFFF, 1},
+    {0x018C, 0x018C, 0xFFFF, 1}, {0x0192, 0x0192, 0xFFFF, 1}, {0x0195, 0x0195, 0x0061, 1}, {0x0199, 0x0199, 0xFFFF, 1},
+    {0x019A, 0x019A, 0x00A3, 1}, {0x019E, 0x019E, 0x0082, 1}, {0x01A1, 0x01A5, 0xFFFF, 2}, {0x01A8, 0x01A8, 0xFFFF, 1},
+    {0x01AD, 0x01AD, 0xFFFF, 1}, {0x01B0, 0x01B0, 0xFFFF, 1}, {0x01B4, 0x01B6, 0xFFFF, 2}, {0x01B9, 0x01B9, 0xFFFF, 1},
+    {0x01BD, 0x01BD, 0xFFFF, 1}, {0x01BF, 0x01BF, 0x0038, 1}, {0x01C5, 0x01C5, 0xFFFF, 1}, {0x01C6, 0x01C6, 0xFFFE, 1},
+    {0x01C8, 0x01C8, 0xFFFF, 1}, {0x01C9, 0x01C9, 0xFFFE, 1}, {0x01CB, 0x01CB, 0xFFFF, 1}, {0x01CC, 0x01CC, 0xFFFE, 1},
+    {0x01CE, 0x01DC, 0xFFFF, 2}, {0x01DD, 0x01DD, 0xFFB1, 1}, {0x01DF, 0x01EF, 0xFFFF, 2}, {0x01F2, 0x01F2, 0xFFFF, 1},
+    {0x01F3, 0x01F3, 0xFFFE, 1}, {0x01F5, 0x01F5, 0xFFFF, 1}, {0x01F9, 0x021F, 0xFFFF, 2}, {0x0223, 0x0233, 0xFFFF, 2},
+    {0x023C, 0x023C, 0xFFFF, 1}, {0x023F, 0x0240, 0x2A3F, 1}, {0x0242, 0x0242, 0xFFFF, 1}, {0x0247, 0x024F, 0xFFFF, 2},
+    {0x0250, 0x0250, 0x2A1F, 1}, {0x0251, 0x0251, 0x2A1C, 1}, {0x0252, 0x0252, 0x2A1E, 1}, {0x0253, 0x0253, 0xFF2E, 1},
+    {0x0254, 0x0254, 0xFF32, 1}, {0x0256, 0x0257, 0xFF33, 1}, {0x0259, 0x0259, 0xFF36, 1}, {0x025B, 0x025B, 0xFF35, 1},
+    {0x025C, 0x025C, 0xA54F, 1}, {0x0260, 0x0260, 0xFF33, 1}, {0x0261, 0x0261, 0xA54B, 1}, {0x0263, 0x0263, 0xFF31, 1},
+    {0x0265, 0x0265, 0xA528, 1}, {0x0266, 0x0266, 0xA544, 1}, {0x0268, 0x0268, 0xFF2F, 1}, {0x0269, 0x0269, 0xFF2D, 1},
+    {0x026A, 0x026A, 0xA544, 1}, {0x026B, 0x026B, 0x29F7, 1}, {0x026C, 0x026C, 0xA541, 1}, {0x026F, 0x026F, 0xFF2D, 1},
+    {0x0271, 0x0271, 0x29FD, 1}, {0x0272, 0x0272, 0xFF2B, 1}, {0x0275, 0x0275, 0xFF2A, 1}, {0x027D, 0x027D, 0x29E7, 1},
+    {0x0280, 0x0280, 0xFF26, 1}, {0x0282, 0x0282, 0xA543, 1}, {0x0283, 0x0283, 0xFF26, 1}, {0x0287, 0x0287, 0xA52A, 1},
+    {0x0288, 0x0288, 0xFF26, 1}, {0x0289, 0x0289, 0xFFBB, 1}, {0x028A, 0x028B, 0xFF27, 1}, {0x028C, 0x028C, 0xFFB9, 1},
+    {0x0292, 0x0292, 0xFF25, 1}, {0x029D, 0x029D, 0xA515, 1}, {0x029E, 0x029E, 0xA512, 1}, {0x0345, 0x0345, 0x0054, 1},
+    {0x0371, 0x0373, 0xFFFF, 2}, {0x0377, 0x0377, 0xFFFF, 1}, {0x037B, 0x037D, 0x0082, 1}, {0x03AC, 0x03AC, 0xFFDA, 1},
+    {0x03AD, 0x03AF, 0xFFDB, 1}, {0x03B1, 0x03C1, 0xFFE0, 1}, {0x03C2, 0x03C2, 0xFFE1, 1}, {0x03C3, 0x03CB, 0xFFE0, 1},
+    {0x03CC, 0x03CC, 0xFFC0, 1}, {0x03CD, 0x03CE, 0xFFC1, 1}, {0x03D0, 0x03D0, 0xFFC2, 1}, {0x03D1, 0x03D1, 0xFFC7, 1},
+    {0x03D5, 0x03D5, 0xFFD1, 1}, {0x03D6, 0x03D6, 0xFFCA, 1}, {0x03D7, 0x03D7, 0xFFF8, 1}, {0x03D9, 0x03EF, 0xFFFF, 2},
+    {0x03F0, 0x03F0, 0xFFAA, 1}, {0x03F1, 0x03F1, 0xFFB0, 1}, {0x03F2, 0x03F2, 0x0007, 1}, {0x03F3, 0x03F3, 0xFF8C, 1},
+    {0x03F5, 0x03F5, 0xFFA0, 1}, {0x03F8, 0x03F8, 0xFFFF, 1}, {0x03FB, 0x03FB, 0xFFFF, 1}, {0x0430, 0x044F, 0xFFE0, 1},
+    {0x0450, 0x045F, 0xFFB0, 1}, {0x0461, 0x0481, 0xFFFF, 2}, {0x048B, 0x04BF, 0xFFFF, 2}, {0x04C2, 0x04CE, 0xFFFF, 2},
+    {0x04CF, 0x04CF, 0xFFF1, 1}, {0x04D1, 0x052F, 0xFFFF, 2}, {0x0561, 0x0586, 0xFFD0, 1}, {0x10D0, 0x10FA, 0x0BC0, 1},
+    {0x10FD, 0x10FF, 0x0BC0, 1}, {0x13F8, 0x13FD, 0xFFF8, 1}, {0x1C80, 0x1C80, 0xE792, 1}, {0x1C81, 0x1C81, 0xE793, 1},
+    {0x1C82, 0x1C82, 0xE79C, 1}, {0x1C83, 0x1C84, 0xE79E, 1}, {0x1C85, 0x1C85, 0xE79D, 1}, {0x1C86, 0x1C86, 0xE7A4, 1},
+    {0x1C87, 0x1C87, 0xE7DB, 1}, {0x1C88, 0x1C88, 0x89C2, 1}, {0x1D79, 0x1D79, 0x8A04, 1}, {0x1D7D, 0x1D7D, 0x0EE6, 1},
+    {0x1D8E, 0x1D8E, 0x8A38, 1}, {0x1E01, 0x1E95, 0xFFFF, 2}, {0x1E9B, 0x1E9B, 0xFFC5, 1}, {0x1EA1, 0x1EFF, 0xFFFF, 2},
+    {0x1F00, 0x1F07, 0x0008, 1}, {0x1F10, 0x1F15, 0x0008, 1}, {0x1F20, 0x1F27, 0x0008, 1}, {0x1F30, 0x1F37, 0x0008, 1},
+    {0x1F40, 0x1F45, 0x0008, 1}, {0x1F51, 0x1F57, 0x0008, 2}, {0x1F60, 0x1F67, 0x0008, 1}, {0x1F70, 0x1F71, 0x004A, 1},
+    {0x1F72, 0x1F75, 0x0056, 1}, {0x1F76, 0x1F77, 0x0064, 1}, {0x1F78, 0x1F79, 0x0080, 1}, {0x1F7A, 0x1F7B, 0x0070, 1},
+    {0x1F7C, 0x1F7D, 0x007E, 1}, {0x1FB0, 0x1FB1, 0x0008, 1}, {0x1FBE, 0x1FBE, 0xE3DB, 1}, {0x1FD0, 0x1FD1, 0x0008, 1},
+    {0x1FE0, 0x1FE1, 0x0008, 1}, {0x1FE5, 0x1FE5, 0x0007, 1}, {0x214E, 0x214E, 0xFFE4, 1}, {0x2170, 0x217F, 0xFFF0, 1},
+    {0x2184, 0x2184, 0xFFFF, 1}, {0x24D0, 0x24E9, 0xFFE6, 1}, {0x2C30, 0x2C5F, 0xFFD0, 1}, {0x2C61, 0x2C61, 0xFFFF, 1},
+    {0x2C65, 0x2C65, 0xD5D5, 1}, {0x2C66, 0x2C66, 0xD5D8, 1}, {0x2C68, 0x2C6C, 0xFFFF, 2}, {0x2C73, 0x2C73, 0xFFFF, 1},
+    {0x2C76, 0x2C76, 0xFFFF, 1}, {0x2C81, 0x2CE3, 0xFFFF, 2}, {0x2CEC, 0x2CEE, 0xFFFF, 2}, {0x2CF3, 0x2CF3, 0xFFFF, 1},
+    {0x2D00, 0x2D25, 0xE3A0, 1}, {0x2D27, 0x2D27, 0xE3A0, 1}, {0x2D2D, 0x2D2D, 0xE3A0, 1}, {0xA641, 0xA66D, 0xFFFF, 2},
+    {0xA681, 0xA69B, 0xFFFF, 2}, {0xA723, 0xA72F, 0xFFFF, 2}, {0xA733, 0xA76F, 0xFFFF, 2}, {0xA77A, 0xA77C, 0xFFFF, 2},
+    {0xA77F, 0xA787, 0xFFFF, 2}, {0xA78C, 0xA78C, 0xFFFF, 1}, {0xA791, 0xA793, 0xFFFF, 2}, {0xA794, 0xA794, 0x0030, 1},
+    {0xA797, 0xA7A9, 0xFFFF, 2}, {0xA7B5, 0xA7C3, 0xFFFF, 2}, {0xA7C8, 0xA7CA, 0xFFFF, 2}, {0xA7D1, 0xA7D1, 0xFFFF, 1},
+    {0xA7D7, 0xA7D9, 0xFFFF, 2}, {0xA7F6, 0xA7F6, 0xFFFF, 1}, {0xAB53, 0xAB53, 0xFC60, 1}, {0xAB70, 0xABBF, 0x6830, 1},
+    {0xFF41, 0xFF5A, 0xFFE0, 1},
+  };
+
+  // upcase folds one code unit. Surrogates and supplementary characters are unchanged, the file system compares
+  // UTF-16 code units.
+  constexpr char32_t upcase(char32_t c) {
+    if (c < 0x80) {
+      return c >= 'a' && c <= 'z' ? c - 0x20 : c;
+    }
+    if (c < std::begin(upcase_ranges)->first || c > std::prev(std::end(upcase_ranges))->last) {
+      return c;
+    }
+    auto it = std::upper_bound(std::begin(upcase_ranges), std::end(upcase_ranges), c,
+                               [](char32_t v, const upcase_range &r) { return v < r.first; });
+    --it;
+    if (c > it->last || (c - it->first) % it->stride != 0) {
+      return c;
+    }
+    return (c + it->delta) & 0xFFFF;
+  }
+  template <typename charT> constexpr charT fold_unit(charT c) {
+    using unit_t = std::conditional_t<sizeof(charT) == 2, uint16_t, uint32_t>;
+    return static_cast<charT>(upcase(static_cast<unit_t>(c)));
+  }
+
+  template <typename charT>
+  concept path_unit = std::is_same_v<charT, wchar_t> || std::is_same_v<charT, char16_t> ||
+                      std::is_same_v<charT, char32_t>;
+
+  // The hash consumes the folded path as 64-bit words: 4 UTF-16 or 2 UTF-32 code units in memory order, the last
+  // word zero padded, then the length. Scalar and vector code fold the same words, a path hashes the same whichever
+  // route folded it.
+  template <typename charT> constexpr size_t units_per_word = sizeof(uint64_t) / sizeof(charT);
+  constexpr uint64_t mix(uint64_t h, uint64_t w) {
+    h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 29);
+  }
+  constexpr uint64_t finish(uint64_t h, size_t n) {
+    h ^= static_cast<uint64_t>(n);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    return h ^ (h >> 33);
+  }
+  constexpr uint64_t seed = 0x243F6A8885A308D3ULL;
+  // hash_scalar folds and mixes n code units, a word at a time
+  template <typename charT> constexpr uint64_t hash_scalar(uint64_t h, const charT *p, size_t n) {
+    constexpr auto k = units_per_word<charT>;
+    for (size_t i = 0; i < n; i += k) {
+      std::array<charT, k> word{};
+      for (size_t j = 0; j < k && i + j < n; j++) {
+        word[j] = fold_unit(p[i + j]);
+      }
+      h = mix(h, std::bit_cast<uint64_t>(word));
+    }
+    return h;
+  }
+  template <typename charT> constexpr void fold_scalar(const charT *p, size_t n, charT *out) {
+    for (size_t i = 0; i < n; i++) {
+      out[i] = fold_unit(p[i]);
+    }
+  }
+  template <typename charT> constexpr bool equal_scalar(const charT *a, const charT *b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      if (a[i] != b[i] && fold_unit(a[i]) != fold_unit(b[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+#if defined(BELA_PATH_FOLD_AVX2) || defined(BELA_PATH_FOLD_SSE2)
+  // Vector folding: 'a'..'z' lanes lose 0x20, lanes at or above 0x80 are patched from the table afterwards. Paths
+  // are ASCII nearly always, then a whole vector folds in five instructions.
+#if defined(BELA_PATH_FOLD_AVX2)
+  using simd_t = __m256i;
+  inline simd_t simd_load(const void *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+  inline void simd_store(void *p, simd_t v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+  inline simd_t simd_and(simd_t a, simd_t b) { return _mm256_and_si256(a, b); }
+  inline unsigned simd_mask(simd_t a) { return static_cast<unsigned>(_mm256_movemask_epi8(a)); }
+  constexpr unsigned simd_full = 0xFFFFFFFFU;
+  template <typename charT> inline simd_t simd_splat(int c) {
+    return sizeof(charT) == 2 ? _mm256_set1_epi16(static_cast<short>(c)) : _mm256_set1_epi32(c);
+  }
+  template <typename charT> inline simd_t simd_eq(simd_t a, simd_t b) {
+    return sizeof(charT) == 2 ? _mm256_cmpeq_epi16(a, b) : _mm256_cmpeq_epi32(a, b);
+  }
+  template <typename charT> inline simd_t simd_gt(simd_t a, simd_t b) {
+    return sizeof(charT) == 2 ? _mm256_cmpgt_epi16(a, b) : _mm256_cmpgt_epi32(a, b);
+  }
+  template <typename charT> inline simd_t simd_sub(simd_t a, simd_t b) {
+    return sizeof(charT) == 2 ? _mm256_sub_epi16(a, b) : _mm256_sub_epi32(a, b);
+  }
+#else
+  using simd_t = __m128i;
+  inline simd_t simd_load(const void *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+  inline void simd_store(void *p, simd_t v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+  inline simd_t simd_and(simd_t a, simd_t b) { return _mm_and_si128(a, b); }
+  inline unsigned simd_mask(simd_t a) { return static_cast<unsigned>(_mm_movemask_epi8(a)); }
+  constexpr unsigned simd_full = 0xFFFFU;
+  template <typename charT> inline simd_t simd_splat(int c) {
+    return sizeof(charT) == 2 ? _mm_set1_epi16(static_cast<short>(c)) : _mm_set1_epi32(c);
+  }
+  template <typename charT> inline simd_t simd_eq(simd_t a, simd_t b) {
+    return sizeof(charT) == 2 ? _mm_cmpeq_epi16(a, b) : _mm_cmpeq_epi32(a, b);
+  }
+  template <typename charT> inline simd_t simd_gt(simd_t a, simd_t b) {
+    return sizeof(charT) == 2 ? _mm_cmpgt_epi16(a, b) : _mm_cmpgt_epi32(a, b);
+  }
+  template <typename charT> inline simd_t simd_sub(simd_t a, simd_t b) {
+    return sizeof(charT) == 2 ? _mm_sub_epi16(a, b) : _mm_sub_epi32(a, b);
+  }
+#endif
+  template <typename charT> constexpr size_t simd_lanes = sizeof(simd_t) / sizeof(charT);
+
+  // simd_ascii is true when every lane is below 0x80; UTF-16 lanes above 0x7FFF compare negative, the mask test
+  // does not depend on signedness
+  template <typename charT> inline bool simd_ascii(simd_t v) {
+    auto high = simd_and(v, simd_splat<charT>(~0x7F));
+    return simd_mask(simd_eq<charT>(high, simd_splat<charT>(0))) == simd_full;
+  }
+  template <typename charT> inline simd_t simd_fold_ascii(simd_t v) {
+    auto lower = simd_and(simd_gt<charT>(v, simd_splat<charT>('a' - 1)), simd_gt<charT>(simd_splat<charT>('z' + 1), v));
+    return simd_sub<charT>(v, simd_and(lower, simd_splat<charT>(0x20)));
+  }
+  // simd_fold folds one vector of p to out
+  template <typename charT> inline void simd_fold(const charT *p, charT *out) {
+    auto v = simd_load(p);
+    simd_store(out, simd_fold_ascii<charT>(v));
+    if (!simd_ascii<charT>(v)) {
+      for (size_t i = 0; i < simd_lanes<charT>; i++) {
+        if (static_cast<char32_t>(p[i]) >= 0x80) {
+          out[i] = fold_unit(p[i]);
+        }
+      }
+    }
+  }
+
+  template <typename charT> inline uint64_t hash_simd(const charT *p, size_t n) {
+    constexpr auto words = sizeof(simd_t) / sizeof(uint64_t);
+    uint64_t h = seed;
+    size_t i = 0;
+    for (; i + simd_lanes<charT> <= n; i += simd_lanes<charT>) {
+      charT folded[simd_lanes<charT>];
+      uint64_t w[words];
+      simd_fold(p + i, folded);
+      std::memcpy(w, folded, sizeof(w));
+      for (auto x : w) {
+        h = mix(h, x);
+      }
+    }
+    return finish(hash_scalar(h, p + i, n - i), n);
+  }
+  template <typename charT> inline void fold_simd(const charT *p, size_t n, charT *out) {
+    size_t i = 0;
+    for (; i + simd_lanes<charT> <= n; i += simd_lanes<charT>) {
+      simd_fold(p + i, out + i);
+    }
+    fold_scalar(p + i, n - i, out + i);
+  }
+  template <typename charT> inline bool equal_simd(const charT *a, const charT *b, size_t n) {
+    size_t i = 0;
+    for (; i + simd_lanes<charT> <= n; i += simd_lanes<charT>) {
+      auto va = simd_load(a + i);
+      auto vb = simd_load(b + i);
+      if (simd_mask(simd_eq<charT>(va, vb)) == simd_full) {
+        continue;
+      }
+      if (simd_ascii<charT>(va) && simd_ascii<charT>(vb)) {
+        if (simd_mask(simd_eq<charT>(simd_fold_ascii<charT>(va), simd_fold_ascii<charT>(vb))) != simd_full) {
+          return false;
+        }
+        continue;
+      }
+      if (!equal_scalar(a + i, b + i, simd_lanes<charT>)) {
+        return false;
+      }
+    }
+    return equal_scalar(a + i, b + i, n - i);
+  }
+#endif
+} // namespace fold_internal
+
+// fold_case_to writes the uppercase fold of sv to out, sv.size() code units
+template <fold_internal::path_unit charT> constexpr void fold_case_to(std::basic_string_view<charT> sv, charT *out) {
+#if defined(BELA_PATH_FOLD_AVX2) || defined(BELA_PATH_FOLD_SSE2)
+  if (!std::is_constant_evaluated()) {
+    return fold_internal::fold_simd(sv.data(), sv.size(), out);
+  }
+#endif
+  fold_internal::fold_scalar(sv.data(), sv.size(), out);
+}
+template <fold_internal::path_unit charT> std::basic_string<charT> fold_case(std::basic_string_view<charT> sv) {
+  std::basic_string<charT> s;
+  // reserved first: libstdc++ 12 writes past the small string buffer when resize_and_overwrite has to grow it
+  s.reserve(sv.size());
+  s.resize_and_overwrite(sv.size(), [&](charT *p, size_t n) {
+    fold_case_to(sv, p);
+    return n;
+  });
+  return s;
+}
+// hash_fold hashes the fold of sv: paths that compare equal under equal_fold hash the same
+template <fold_internal::path_unit charT> constexpr uint64_t hash_fold(std::basic_string_view<charT> sv) {
+#if defined(BELA_PATH_FOLD_AVX2) || defined(BELA_PATH_FOLD_SSE2)
+  if (!std::is_constant_evaluated()) {
+    return fold_internal::hash_simd(sv.data(), sv.size());
+  }
+#endif
+  return fold_internal::finish(fold_internal::hash_scalar(fold_internal::seed, sv.data(), sv.size()), sv.size());
+}
+// equal_fold compares two paths the way the file system does, case-insensitively code unit by code unit
+template <fold_internal::path_unit charT>
+constexpr bool equal_fold(std::basic_string_view<charT> a, std::type_identity_t<std::basic_string_view<charT>> b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+#if defined(BELA_PATH_FOLD_AVX2) || defined(BELA_PATH_FOLD_SSE2)
+  if (!std::is_constant_evaluated()) {
+    return fold_internal::equal_simd(a.data(), b.data(), a.size());
+  }
+#endif
+  return fold_internal::equal_scalar(a.data(), b.data(), a.size());
+}
+
+// basic_fold_hash and basic_fold_equal key unordered containers on paths, transparent so that a string_view finds
+// a std::wstring key without a copy
+template <fold_internal::path_unit charT> struct basic_fold_hash {
+  using is_transparent = void;
+  size_t operator()(std::basic_string_view<charT> sv) const { return static_cast<size_t>(hash_fold(sv)); }
+};
+template <fold_internal::path_unit charT> struct basic_fold_equal {
+  using is_transparent = void;
+  bool operator()(std::basic_string_view<charT> a, std::basic_string_view<charT> b) const { return equal_fold(a, b); }
+};
+
+using fold_hash = basic_fold_hash<wchar_t>;
+using fold_equal = basic_fold_equal<wchar_t>;
+
+static_assert(fold_internal::upcase(U'a') == U'A' && fold_internal::upcase(U'\u00E9') == U'\u00C9');
+static_assert(fold_internal::upcase(U'\u0131') == U'\u0131' && fold_internal::upcase(U'\u0101') == U'\u0100');
+static_assert(equal_fold(std::u16string_view(u"C:\\Program Files\\Git"), u"c:\\PROGRAM FILES\\git"));
+
+} // namespace bela
+
+#endif
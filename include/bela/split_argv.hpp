@@ -0,0 +1,202 @@
+// Split command lines
+#ifndef BELA_SPLIT_ARGV_HPP
+#define BELA_SPLIT_ARGV_HPP
+#include <string>
+#include <string_view>
+#include <span>
+#include <type_traits>
+#include "escape_argv.hpp"
+
+namespace bela {
+
+// basic_argv_token is one argument of a command line. raw is the argument as written, quotes and escapes included.
+// Most arguments are plain or simply quoted, then value is the argument itself, a view into the command line;
+// escaped arguments (\" "" or a" "b) do not exist anywhere as written and decode_to rebuilds them.
+template <typename charT> struct basic_argv_token {
+  using string_view_t = std::basic_string_view<charT>;
+  string_view_t raw;
+  string_view_t value;
+  bool escaped{false};
+  // decode_to writes the argument to an argv_sink
+  template <typename Sink> constexpr void decode_to(Sink &sink) const;
+  std::basic_string<charT> str() const {
+    std::basic_string<charT> s;
+    basic_string_sink<charT> sink(s);
+    decode_to(sink);
+    return s;
+  }
+};
+
+namespace argv_internal {
+  template <typename charT> constexpr bool is_blank(charT c) { return c == ' ' || c == '\t'; }
+
+  // parse_argument runs the CommandLineToArgvW rules over the argument at the start of sv and returns its length.
+  // 2n backslashes before a quote are n backslashes and the quote opens or closes quoting, 2n+1 are n backslashes and
+  // a literal quote, backslashes elsewhere are literal. Inside quotes every third consecutive quote is literal.
+  template <typename charT, typename Sink>
+  constexpr size_t parse_argument(std::basic_string_view<charT> sv, Sink &sink) {
+    size_t i = 0;
+    size_t slashes = 0;
+    int quotes = 0; // odd while quoted
+    auto flush = [&](size_t n) {
+      for (; n > 0; n--) {
+        sink.put('\\');
+      }
+    };
+    while (i < sv.size()) {
+      auto c = sv[i];
+      if (is_blank(c) && quotes == 0) {
+        break;
+      }
+      if (c == '\\') {
+        slashes++;
+        i++;
+        continue;
+      }
+      if (c != '"') {
+        flush(slashes);
+        slashes = 0;
+        auto begin = i;
+        while (i < sv.size() && sv[i] != '\\' && sv[i] != '"' && (quotes != 0 || !is_blank(sv[i]))) {
+          i++;
+        }
+        sink.write(sv.data() + begin, i - begin);
+        continue;
+      }
+      flush(slashes / 2);
+      if (slashes % 2 == 0) {
+        quotes++;
+      } else {
+        sink.put('"');
+      }
+      slashes = 0;
+      for (i++; i < sv.size() && sv[i] == '"'; i++) {
+        if (++quotes == 3) {
+          sink.put('"');
+          quotes = 0;
+        }
+      }
+      if (quotes == 2) {
+        quotes = 0;
+      }
+    }
+    flush(slashes);
+    return i;
+  }
+
+  // null_sink measures nothing, parse_argument only finds the end of an argument with it
+  template <typename charT> struct null_sink {
+    constexpr void write(const charT *, size_t) {}
+    constexpr void put(charT) {}
+  };
+
+  // contiguous returns the argument when raw decodes to a part of itself: no quotes and no backslash before one, or
+  // one pair of quotes around such text that does not end with a backslash
+  template <typename charT>
+  constexpr bool contiguous(std::basic_string_view<charT> raw, std::basic_string_view<charT> &value) {
+    auto q = raw.find('"');
+    if (q == std::basic_string_view<charT>::npos) {
+      value = raw;
+      return true;
+    }
+    if (q != 0 || raw.size() < 2 || raw.back() != '"') {
+      return false;
+    }
+    auto inner = raw.substr(1, raw.size() - 2);
+    if (inner.find('"') != std::basic_string_view<charT>::npos || (!inner.empty() && inner.back() == '\\')) {
+      return false;
+    }
+    value = inner;
+    return true;
+  }
+} // namespace argv_internal
+
+template <typename charT>
+template <typename Sink>
+constexpr void basic_argv_token<charT>::decode_to(Sink &sink) const {
+  if (!escaped) {
+    sink.write(value.data(), value.size());
+    return;
+  }
+  argv_internal::parse_argument(raw, sink);
+}
+
+// basic_argv_splitter walks the arguments of a command line the way CommandLineToArgvW does. The first argument is the
+// program name, it follows its own rule: a quoted name ends at the next quote, backslashes are not escapes.
+template <typename charT> class basic_argv_splitter {
+public:
+  using string_view_t = std::basic_string_view<charT>;
+  using token_t = basic_argv_token<charT>;
+  explicit constexpr basic_argv_splitter(string_view_t cmdline_) : cmdline(cmdline_) {}
+  // Next stores the next argument in token, false at the end of the command line
+  constexpr bool Next(token_t &token) {
+    if (!started) {
+      started = true;
+      if (cmdline.empty()) {
+        return false;
+      }
+      return program(token);
+    }
+    while (pos < cmdline.size() && argv_internal::is_blank(cmdline[pos])) {
+      pos++;
+    }
+    if (pos == cmdline.size()) {
+      return false;
+    }
+    argv_internal::null_sink<charT> sink;
+    auto rest = cmdline.substr(pos);
+    token.raw = rest.substr(0, argv_internal::parse_argument(rest, sink));
+    token.escaped = !argv_internal::contiguous(token.raw, token.value);
+    if (token.escaped) {
+      token.value = {};
+    }
+    pos += token.raw.size();
+    return true;
+  }
+
+private:
+  constexpr bool program(token_t &token) {
+    if (cmdline[0] == '"') {
+      auto end = cmdline.find('"', 1);
+      auto n = end == string_view_t::npos ? cmdline.size() : end + 1;
+      token.raw = cmdline.substr(0, n);
+      token.value = cmdline.substr(1, (end == string_view_t::npos ? cmdline.size() : end) - 1);
+    } else {
+      size_t n = 0;
+      while (n < cmdline.size() && !argv_internal::is_blank(cmdline[n])) {
+        n++;
+      }
+      token.raw = token.value = cmdline.substr(0, n);
+    }
+    token.escaped = false;
+    pos = token.raw.size();
+    return true;
+  }
+  string_view_t cmdline;
+  size_t pos{0};
+  bool started{false};
+};
+
+// split_argv stores the first out.size() arguments of cmdline in out without allocating and returns the number of
+// arguments, which is larger than out.size() when they did not all fit
+template <typename charT>
+constexpr size_t split_argv(std::basic_string_view<charT> cmdline,
+                            std::type_identity_t<std::span<basic_argv_token<charT>>> out) {
+  basic_argv_splitter<charT> splitter(cmdline);
+  basic_argv_token<charT> token;
+  size_t n = 0;
+  while (splitter.Next(token)) {
+    if (n < out.size()) {
+      out[n] = token;
+    }
+    n++;
+  }
+  return n;
+}
+
+using argv_token = basic_argv_token<wchar_t>;
+using argv_splitter = basic_argv_splitter<wchar_t>;
+
+} // namespace bela
+
+#endif
@@ -0,0 +1,95 @@
+// Pack many arguments into as few command lines as possible
+#ifndef WINMENU_ARGV_PACKER_HPP
+#define WINMENU_ARGV_PACKER_HPP
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <bela/escape_argv.hpp>
+
+namespace winmenu {
+// CreateProcessW limits lpCommandLine to 32767 characters including the terminating null character
+constexpr size_t command_line_limit = 32767;
+
+// basic_argv_packer builds 'prefix arg1 arg2 ... suffix' command lines, each at most limit characters including the
+// terminating null character. Append only classifies the argument and borrows it, a new command line is started
+// whenever the next argument does not fit; Finish sizes every command line exactly and escapes the arguments straight
+// into it, so each argument is scanned once and copied once.
+template <typename charT> class basic_argv_packer {
+public:
+  using string_view_t = std::basic_string_view<charT>;
+  using string_t = std::basic_string<charT>;
+  basic_argv_packer(string_view_t prefix_, string_view_t suffix_, size_t limit_ = command_line_limit)
+      : prefix(prefix_), suffix(suffix_), limit(limit_) {}
+  basic_argv_packer(const basic_argv_packer &) = delete;
+  basic_argv_packer &operator=(const basic_argv_packer &) = delete;
+  // Reserve makes room for n arguments
+  void Reserve(size_t n) { args.reserve(n); }
+  // Append returns false when arg cannot fit even in a command line of its own, arg is skipped. arg must stay valid
+  // until Finish.
+  bool Append(string_view_t arg) {
+    auto ec = bela::argv_internal::classify(arg);
+    auto escaped = bela::argv_internal::escaped_size(arg, ec);
+    if (fixed_size() + escaped + 1 > limit - 1) {
+      return false;
+    }
+    if (groups.empty() || prefix.size() + groups.back().escaped + escaped + 2 + suffix_size() > limit - 1) {
+      groups.push_back({args.size(), args.size(), 0});
+    }
+    args.push_back({arg, ec});
+    groups.back().last++;
+    groups.back().escaped += escaped + (groups.back().escaped == 0 ? 0 : 1);
+    return true;
+  }
+  // Finish returns the packed command lines, the packer can be reused afterwards
+  std::vector<string_t> Finish() {
+    std::vector<string_t> lines;
+    lines.reserve(groups.size());
+    for (const auto &g : groups) {
+      // reserved first: libstdc++ 12 writes past the small string buffer when resize_and_overwrite has to grow it
+      auto size = prefix.size() + 1 + g.escaped + suffix_size();
+      string_t line;
+      line.reserve(size);
+      line.resize_and_overwrite(size, [&](charT *p, size_t n) {
+        auto out = std::char_traits<charT>::copy(p, prefix.data(), prefix.size()) + prefix.size();
+        for (auto i = g.first; i < g.last; i++) {
+          *out++ = ' ';
+          out = bela::argv_internal::escape_to(args[i].arg, args[i].ec, out);
+        }
+        if (!suffix.empty()) {
+          *out++ = ' ';
+          out = std::char_traits<charT>::copy(out, suffix.data(), suffix.size()) + suffix.size();
+        }
+        return n;
+      });
+      lines.emplace_back(std::move(line));
+    }
+    groups.clear();
+    args.clear();
+    return lines;
+  }
+
+private:
+  struct argument {
+    string_view_t arg;
+    bela::argv_internal::escape_class ec;
+  };
+  // group is the range of args packed into one command line and their escaped length, separators included
+  struct group {
+    size_t first;
+    size_t last;
+    size_t escaped;
+  };
+  size_t suffix_size() const { return suffix.empty() ? 0 : suffix.size() + 1; }
+  size_t fixed_size() const { return prefix.size() + suffix_size(); }
+  string_view_t prefix;
+  string_view_t suffix;
+  size_t limit;
+  std::vector<argument> args;
+  std::vector<group> groups;
+};
+
+using argv_packer = basic_argv_packer<wchar_t>;
+} // namespace winmenu
+
+#endif
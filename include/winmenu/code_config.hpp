@@ -0,0 +1,55 @@
+// VS Code shell verb configuration
+#ifndef WINMENU_CODE_CONFIG_HPP
+#define WINMENU_CODE_CONFIG_HPP
+#include <string>
+#include <string_view>
+#include <optional>
+#include <functional>
+#include <bela/command_template.hpp>
+#include "path_interner.hpp"
+#include "resolved_cache.hpp"
+#include "platform.hpp"
+
+namespace winmenu {
+
+constexpr std::wstring_view code_shell_key = LR"(*\shell\VSCode)";
+constexpr std::wstring_view code_command_key = LR"(*\shell\VSCode\command)";
+
+// code_config is the resolved 'Open with Code' verb registered by the VS Code installer
+struct code_config {
+  bela::command_template command; // compiled command template, e.g. "C:\...\Code.exe" "%1"
+  interned_path icon;             // icon resource path, environment expanded, may be empty
+};
+
+std::optional<code_config> resolve_code_config(config_source &source);
+
+// code_config_watcher is the change notification side of the lookup
+class code_config_watcher {
+public:
+  virtual ~code_config_watcher() = default;
+  // watch replaces any previous watch with a change notification covering code_shell_key and its subkeys, or its
+  // parent *\shell while VS Code is not installed. changed may be called from any thread. Returns false if neither can
+  // be watched.
+  virtual bool watch(std::function<void()> changed) = 0;
+};
+
+// code_config_resolver reads the verb for code_config_cache
+struct code_config_resolver {
+  config_source &source;
+  std::optional<code_config> operator()() const { return resolve_code_config(source); }
+};
+
+// code_config_cache memoizes the lookup, including a missing VS Code. The watch stays registered after a notification
+// (a registry watcher re-arms itself) until the next get() replaces it, which moves a watch on *\shell to the VSCode
+// key once VS Code has been installed.
+class code_config_cache final : public watched_cache<code_config_resolver, code_config_watcher> {
+public:
+  code_config_cache(config_source &source, code_config_watcher &watcher,
+                    clock::duration positiveTtl = default_positive_ttl,
+                    clock::duration negativeTtl = default_negative_ttl)
+      : watched_cache({source}, watcher, positiveTtl, negativeTtl) {}
+};
+
+} // namespace winmenu
+
+#endif
@@ -0,0 +1,68 @@
+// Git for Windows installation lookup
+#ifndef WINMENU_GIT_INSTALL_HPP
+#define WINMENU_GIT_INSTALL_HPP
+#include <string>
+#include <string_view>
+#include <optional>
+#include <functional>
+#include "path_interner.hpp"
+#include "resolved_cache.hpp"
+#include "platform.hpp"
+
+namespace winmenu {
+enum class registry_root { local_machine, current_user };
+
+struct registry_key {
+  registry_root root;
+  std::wstring_view path;
+};
+
+// Git for Windows records its InstallPath under one of these keys, probed in order
+constexpr registry_key git_install_keys[] = {
+    {registry_root::local_machine, LR"(SOFTWARE\GitForWindows)"},
+    {registry_root::local_machine, LR"(SOFTWARE\WOW6432Node\GitForWindows)"},
+    {registry_root::current_user, LR"(SOFTWARE\GitForWindows)"},
+    {registry_root::current_user, LR"(SOFTWARE\WOW6432Node\GitForWindows)"},
+};
+
+// git_install_backend is the registry side of the lookup: the InstallPath probe and change notifications
+class git_install_backend {
+public:
+  virtual ~git_install_backend() = default;
+  // install_path returns InstallPath from the first of git_install_keys that has one
+  virtual std::optional<std::wstring> install_path() = 0;
+  // watch replaces any previous watches with change notifications covering every key in git_install_keys (or its
+  // nearest existing parent). changed may be called from any thread. Returns false if the keys cannot be watched.
+  virtual bool watch(std::function<void()> changed) = 0;
+};
+
+// git_install paths are interned, resolving the same installation again after a change notification shares them
+struct git_install {
+  interned_path install_path;
+  interned_path git_bash; // ${install_path}\git-bash.exe
+  interned_path git_gui;  // ${install_path}\cmd\git-gui.exe, empty when Git GUI was not installed
+};
+
+std::optional<git_install> resolve_git_install(git_install_backend &backend, filesystem_probe &fs);
+
+// git_install_resolver probes the installation for git_install_cache
+struct git_install_resolver {
+  git_install_backend &backend;
+  filesystem_probe &fs;
+  std::optional<git_install> operator()() const { return resolve_git_install(backend, fs); }
+};
+
+// git_install_cache memoizes the lookup, including a missing installation. The watches of the backend stay registered
+// after a notification (a registry watcher re-arms itself) until the next get() replaces them, which also moves a
+// parent key watch to the GitForWindows key once it exists.
+class git_install_cache final : public watched_cache<git_install_resolver, git_install_backend> {
+public:
+  git_install_cache(git_install_backend &backend, filesystem_probe &fs,
+                    clock::duration positiveTtl = default_positive_ttl,
+                    clock::duration negativeTtl = default_negative_ttl)
+      : watched_cache({backend, fs}, backend, positiveTtl, negativeTtl) {}
+};
+
+} // namespace winmenu
+
+#endif
@@ -0,0 +1,27 @@
+// Verb invoke pipeline
+#ifndef WINMENU_INVOKE_HPP
+#define WINMENU_INVOKE_HPP
+#include <string_view>
+#include "platform.hpp"
+#include "code_config.hpp"
+#include "git_install.hpp"
+
+namespace winmenu {
+
+// parent_directory returns the directory part of a Windows path, drive roots keep their separator (C:\)
+std::wstring_view parent_directory(std::wstring_view path);
+
+// invoke_code opens the selection with VS Code. With batch set, a multi-item selection is packed into as few command
+// lines as fit the CreateProcess limit, otherwise every item gets its own process. Returns the requests launcher
+// accepted, a queueing launcher accepts what it has queued.
+size_t invoke_code(const code_config &cfg, shell_item_list &items, process_launcher &launcher, bool batch);
+
+// invoke_git_bash starts git-bash.exe --cd=directory
+bool invoke_git_bash(const git_install &gi, std::wstring_view directory, process_launcher &launcher);
+
+// invoke_git_gui starts git-gui.exe in directory
+bool invoke_git_gui(const git_install &gi, std::wstring_view directory, process_launcher &launcher);
+
+} // namespace winmenu
+
+#endif
@@ -0,0 +1,67 @@
+// Asynchronous process launch queue
+#ifndef WINMENU_LAUNCH_QUEUE_HPP
+#define WINMENU_LAUNCH_QUEUE_HPP
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include "platform.hpp"
+
+namespace winmenu {
+
+// launch_queue keeps process creation off the calling thread. launch() queues the request and returns at once, a
+// worker started through the executor drains the queue with the inner launcher and exits when it is empty. A request
+// equal to one queued or in flight is coalesced, so a double click does not start two instances. Requests compare as a
+// whole, application, command line and working directory: the same target opened from two working directories is
+// launched twice. Requests the inner launcher rejects are handed to the failure handler on the worker thread.
+//
+// The worker shares the queue state, so destroying the queue does not wait for it; the executor must keep the code
+// alive until the work returns (a module reference on Windows).
+class launch_queue final : public process_launcher {
+public:
+  using work = std::function<void()>;
+  // executor runs work on another thread, returns false when it cannot, the queue is then drained inline
+  using executor = std::function<bool(work)>;
+  using failure_handler = std::function<void(const launch_request &)>;
+  struct statistics {
+    size_t queued{0};
+    size_t launched{0};
+    size_t coalesced{0};
+    size_t failed{0};
+  };
+
+  explicit launch_queue(std::shared_ptr<process_launcher> inner, failure_handler onFailure = {}, executor exec = {});
+  launch_queue(const launch_queue &) = delete;
+  launch_queue &operator=(const launch_queue &) = delete;
+
+  // launch takes the strings of request. It returns true when the request is coalesced, queued behind a running worker
+  // or handed to a new one, whose outcome is reported to the failure handler. When the executor refuses the work the
+  // queue is drained on the calling thread and launch returns whether every request of that drain was launched.
+  bool launch(launch_request &request) override;
+  // wait blocks until every queued request has been launched
+  void wait();
+  [[nodiscard]] bool idle() const;
+  [[nodiscard]] statistics stats() const;
+
+private:
+  struct state {
+    std::shared_ptr<process_launcher> inner;
+    failure_handler onFailure;
+    mutable std::mutex mu;
+    std::condition_variable drained;
+    std::deque<launch_request> queued;
+    std::optional<launch_request> inflight;
+    bool running{false};
+    statistics stats;
+  };
+  // drain returns false when the inner launcher rejected any request
+  static bool drain(const std::shared_ptr<state> &st);
+  std::shared_ptr<state> st;
+  executor exec;
+};
+
+} // namespace winmenu
+
+#endif
@@ -0,0 +1,108 @@
+// Lock-free latency histograms and counters
+#ifndef WINMENU_METRICS_HPP
+#define WINMENU_METRICS_HPP
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include "trace.hpp"
+
+namespace winmenu {
+
+constexpr size_t metric_shards = 8;
+constexpr size_t metric_callbacks = static_cast<size_t>(trace_callback::count_);
+constexpr size_t metric_counters = static_cast<size_t>(trace_counter::count_);
+// HDR style buckets over microseconds: values below 8 get their own bucket, above that every power of two is split
+// into 8 linear sub-buckets (3 significant bits, at most 12.5% error). The last bucket takes everything past ~4h.
+constexpr size_t metric_sub_buckets = 8;
+constexpr size_t metric_buckets = 256;
+
+constexpr size_t metric_bucket(uint64_t us) {
+  if (us < metric_sub_buckets) {
+    return static_cast<size_t>(us);
+  }
+  auto e = static_cast<size_t>(std::bit_width(us)) - 1; // >= 3
+  auto sub = static_cast<size_t>(us >> (e - 3)) & (metric_sub_buckets - 1);
+  auto i = metric_sub_buckets + (e - 3) * metric_sub_buckets + sub;
+  return i < metric_buckets ? i : metric_buckets - 1;
+}
+// metric_bucket_lower returns the smallest value in bucket i
+constexpr uint64_t metric_bucket_lower(size_t i) {
+  if (i < metric_sub_buckets) {
+    return i;
+  }
+  auto e = (i - metric_sub_buckets) / metric_sub_buckets + 3;
+  auto sub = (i - metric_sub_buckets) % metric_sub_buckets;
+  return (uint64_t{1} << e) | (static_cast<uint64_t>(sub) << (e - 3));
+}
+static_assert(metric_bucket(metric_bucket_lower(100)) == 100);
+static_assert(metric_bucket(7) == 7 && metric_bucket(8) == 8 && metric_bucket(16) == 16 && metric_bucket(17) == 16);
+
+// metrics_shard is written by the threads hashed to it, one cache line aligned block each so writers do not share
+// lines
+struct alignas(64) metrics_shard {
+  std::atomic<uint64_t> latency[metric_callbacks][metric_buckets];
+  std::atomic<uint64_t> latency_sum[metric_callbacks]; // microseconds
+  std::atomic<uint64_t> counters[metric_counters];
+};
+
+// metrics_block is a plain block of lock-free atomics without pointers, so it can live in memory shared with an
+// external reader. The header describes the layout; readers must check it before looking at the shards.
+struct metrics_block {
+  static constexpr uint64_t magic_value = 0x315343495254454D; // "METRICS1"
+  static constexpr uint32_t version_value = 1;
+  uint64_t magic;
+  uint32_t version;
+  uint32_t size;
+  uint32_t shards;
+  uint32_t callbacks;
+  uint32_t buckets;
+  uint32_t counters;
+  metrics_shard shard[metric_shards];
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+// metrics_block_valid checks the header written by initialize_metrics_block
+bool metrics_block_valid(const metrics_block &block);
+// initialize_metrics_block zeroes block and writes its header
+void initialize_metrics_block(metrics_block &block);
+
+struct latency_snapshot {
+  std::array<uint64_t, metric_buckets> counts{};
+  uint64_t calls{0};
+  uint64_t sum{0}; // microseconds
+  // percentile returns the lower bound in microseconds of the bucket holding the p-th percentile (0-100)
+  [[nodiscard]] uint64_t percentile(double p) const;
+};
+
+// read_latency and read_counter add the shards of a block up, a reader mapping another process uses them directly
+latency_snapshot read_latency(const metrics_block &block, trace_callback c);
+uint64_t read_counter(const metrics_block &block, trace_counter c);
+
+// metrics records into a metrics_block. Writers only touch their own shard with relaxed increments; readers add the
+// shards up, so a snapshot taken under load may be a few increments behind but never torn per value.
+class metrics {
+public:
+  explicit metrics(metrics_block *block_) : block(block_) {}
+  void record(trace_callback c, uint64_t nanoseconds) {
+    auto us = nanoseconds / 1000;
+    auto &s = block->shard[shard_index()];
+    auto i = static_cast<size_t>(c);
+    s.latency[i][metric_bucket(us)].fetch_add(1, std::memory_order_relaxed);
+    s.latency_sum[i].fetch_add(us, std::memory_order_relaxed);
+  }
+  void add(trace_counter c, uint64_t n) {
+    block->shard[shard_index()].counters[static_cast<size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+  }
+  [[nodiscard]] latency_snapshot latency(trace_callback c) const { return read_latency(*block, c); }
+  [[nodiscard]] uint64_t counter(trace_counter c) const { return read_counter(*block, c); }
+  [[nodiscard]] metrics_block *data() const { return block; }
+
+private:
+  static size_t shard_index();
+  metrics_block *block{nullptr};
+};
+
+} // namespace winmenu
+
+#endif
@@ -0,0 +1,124 @@
+// Process-wide path interning
+#ifndef WINMENU_PATH_INTERNER_HPP
+#define WINMENU_PATH_INTERNER_HPP
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace winmenu {
+
+namespace interner_internal {
+// entry is one interned path, the text follows the header in the same allocation
+struct entry {
+  static constexpr uint32_t dead = 0x80000000U; // refs flag: unlinked, no new handle may be taken
+  std::atomic<entry *> next{nullptr};
+  std::atomic<uint32_t> refs{0};
+  uint64_t hash{0};
+  size_t size{0};
+  uint64_t retired{0};         // epoch the entry was unlinked in
+  entry *retired_next{nullptr}; // retired list, guarded by the interner lock
+  const wchar_t *text() const { return reinterpret_cast<const wchar_t *>(this + 1); }
+  std::wstring_view sv() const { return {text(), size}; }
+};
+} // namespace interner_internal
+
+// interned_path is a counted handle to an interned path. Handles of equal paths (compared case-insensitively) obtained
+// while any of them is alive point to the same text, == compares pointers. The empty handle is the empty path.
+class interned_path {
+public:
+  interned_path() = default;
+  interned_path(const interned_path &other) noexcept : e(other.e) {
+    if (e != nullptr) {
+      e->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  interned_path(interned_path &&other) noexcept : e(std::exchange(other.e, nullptr)) {}
+  interned_path &operator=(interned_path other) noexcept {
+    std::swap(e, other.e);
+    return *this;
+  }
+  ~interned_path() {
+    if (e != nullptr) {
+      e->refs.fetch_sub(1, std::memory_order_release);
+    }
+  }
+  [[nodiscard]] std::wstring_view sv() const { return e == nullptr ? std::wstring_view{} : e->sv(); }
+  operator std::wstring_view() const { return sv(); }
+  [[nodiscard]] const wchar_t *c_str() const { return e == nullptr ? L"" : e->text(); }
+  [[nodiscard]] size_t size() const { return e == nullptr ? 0 : e->size; }
+  [[nodiscard]] bool empty() const { return e == nullptr; }
+  [[nodiscard]] std::wstring str() const { return std::wstring(sv()); }
+  friend bool operator==(const interned_path &a, const interned_path &b) { return a.e == b.e; }
+
+private:
+  friend class path_interner;
+  // adopts a reference taken by the interner
+  explicit interned_path(interner_internal::entry *e_) : e(e_) {}
+  interner_internal::entry *e{nullptr};
+};
+
+// path_interner maps paths to interned_path handles. Lookups walk a fixed bucket array without locking, inserts are
+// serialized. Entries nobody holds stay cached until the table grows past capacity, then they are unlinked and freed
+// once no reader can still be walking over them: every lookup publishes the epoch it started in, an entry unlinked in
+// epoch E is freed when all published epochs are newer than E. Handles still alive when the interner is destroyed keep
+// their entry, it is left to the process.
+class path_interner {
+public:
+  struct statistics {
+    uint64_t hits{0};      // intern and find answered by an existing entry
+    uint64_t misses{0};    // entries created
+    uint64_t reclaimed{0}; // entries freed
+    size_t entries{0};     // entries linked in the table
+    size_t retired{0};     // entries unlinked, waiting for readers to move on
+  };
+  explicit path_interner(size_t capacity = 1024);
+  path_interner(const path_interner &) = delete;
+  path_interner &operator=(const path_interner &) = delete;
+  ~path_interner();
+  // intern returns the handle of path, creating the entry on first use
+  interned_path intern(std::wstring_view path);
+  // find returns the handle of an interned path, the empty handle when path is not interned
+  interned_path find(std::wstring_view path);
+  // collect unlinks every entry without handles and frees what readers have left behind
+  void collect();
+  [[nodiscard]] statistics snapshot();
+
+private:
+  using entry = interner_internal::entry;
+  class reader_guard;
+  static constexpr size_t reader_slots = 64;
+  struct alignas(64) reader_slot {
+    std::atomic<uint64_t> epoch{0}; // epoch of the lookup in progress, 0 when idle
+  };
+  entry *acquire(std::wstring_view path, uint64_t hash);
+  entry *lookup(std::wstring_view path, uint64_t hash);
+  void sweep_locked();
+  void reclaim_locked();
+  size_t capacity;
+  size_t mask;
+  std::unique_ptr<std::atomic<entry *>[]> buckets;
+  reader_slot readers[reader_slots];
+  std::atomic<uint64_t> epoch{1};
+  std::mutex mu;
+  size_t count{0};
+  size_t threshold;
+  entry *retired{nullptr};
+  size_t retiredCount{0};
+  struct {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> reclaimed{0};
+  } counters;
+};
+
+// process_interner is shared by every verb handler of the module
+path_interner &process_interner();
+
+} // namespace winmenu
+
+#endif
@@ -0,0 +1,66 @@
+// Platform interfaces of the WinMenu core
+#ifndef WINMENU_PLATFORM_HPP
+#define WINMENU_PLATFORM_HPP
+#include <string>
+#include <string_view>
+#include <optional>
+#include <cstdint>
+#include "scratch_arena.hpp"
+
+namespace winmenu {
+
+// config_source abstracts the registry (HKEY_CLASSES_ROOT) so configuration resolution does not depend on Windows.
+class config_source {
+public:
+  virtual ~config_source() = default;
+  // read_string reads a REG_SZ/REG_EXPAND_SZ value without expanding it. An empty name reads the default value.
+  virtual std::optional<std::wstring> read_string(std::wstring_view key, std::wstring_view name) = 0;
+  // environment returns the value of an environment variable
+  virtual std::optional<std::wstring> environment(std::wstring_view name) = 0;
+};
+
+class filesystem_probe {
+public:
+  virtual ~filesystem_probe() = default;
+  // exists reports whether path names an existing file (not a directory)
+  virtual bool exists(std::wstring_view path) = 0;
+};
+
+// shell_item_list is the selection Explorer passes to a verb (IShellItemArray)
+class shell_item_list {
+public:
+  virtual ~shell_item_list() = default;
+  virtual size_t count() = 0;
+  // path stores the filesystem path of item index in out, returns false for items without one
+  virtual bool path(size_t index, std::wstring &out) = 0;
+  // copy_path is path with the result carved from arena. Adapters whose source hands out its own buffer override it
+  // to copy straight from there.
+  virtual bool copy_path(size_t index, scratch_arena &arena, std::wstring_view &out) {
+    std::wstring s;
+    if (!path(index, s)) {
+      return false;
+    }
+    out = arena.copy(s);
+    return true;
+  }
+  // attributes returns the bits of mask set on every item (all) and on at least one item (any)
+  virtual bool attributes(uint32_t mask, uint32_t &all, uint32_t &any) = 0;
+};
+
+struct launch_request {
+  std::wstring application;  // optional, CreateProcessW lpApplicationName
+  std::wstring command_line; // writable, CreateProcessW lpCommandLine
+  std::wstring directory;    // optional working directory
+  bool operator==(const launch_request &) const = default;
+};
+
+class process_launcher {
+public:
+  virtual ~process_launcher() = default;
+  // launch may take the strings of request over instead of copying them, they are left empty then
+  virtual bool launch(launch_request &request) = 0;
+};
+
+} // namespace winmenu
+
+#endif
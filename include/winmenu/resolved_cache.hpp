@@ -0,0 +1,152 @@
+// Resolved value cache
+#ifndef WINMENU_RESOLVED_CACHE_HPP
+#define WINMENU_RESOLVED_CACHE_HPP
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <optional>
+#include <cstdint>
+#include <type_traits>
+#include "trace.hpp"
+
+namespace winmenu {
+
+// resolved_cache keeps the last result of an expensive lookup (registry, filesystem) and hands out immutable
+// snapshots to every caller in the process. A missing result (nullptr) is cached as well. invalidate() may be called
+// from any thread, typically a change notification callback; the next get() resolves again. Calling invalidate()
+// while a resolution is in progress discards that result. A cache constructed with times to live also forgets a
+// result by itself, a value after positiveTtl and a missing one after negativeTtl, for lookups nothing notifies of.
+template <typename T> class resolved_cache {
+public:
+  using clock = std::chrono::steady_clock;
+  using value_type = std::shared_ptr<const T>;
+  resolved_cache() = default;
+  resolved_cache(clock::duration positiveTtl_, clock::duration negativeTtl_)
+      : positiveTtl(positiveTtl_), negativeTtl(negativeTtl_) {}
+  resolved_cache(const resolved_cache &) = delete;
+  resolved_cache &operator=(const resolved_cache &) = delete;
+
+  // get returns the cached snapshot or calls resolver, which returns std::optional<T>. Concurrent misses are
+  // collapsed into a single call.
+  template <typename Resolver> value_type get(Resolver &&resolver, clock::time_point now = clock::now()) {
+    value_type value;
+    if (cached(value, now)) {
+      process_tracer().count(trace_counter::cache_hit);
+      return value;
+    }
+    std::lock_guard flight(resolving);
+    if (cached(value, now)) {
+      process_tracer().count(trace_counter::cache_hit);
+      return value;
+    }
+    process_tracer().count(trace_counter::cache_miss);
+    uint64_t current = 0;
+    {
+      std::shared_lock lock(mu);
+      current = generation;
+    }
+    if (auto result = resolver(); result) {
+      value = std::make_shared<const T>(std::move(*result));
+    }
+    std::unique_lock lock(mu);
+    if (generation == current) {
+      saved = value;
+      valid = true;
+      auto ttl = value ? positiveTtl : negativeTtl;
+      expires = ttl == clock::duration::max() ? clock::time_point::max() : now + ttl;
+    }
+    return value;
+  }
+  void invalidate() {
+    std::unique_lock lock(mu);
+    saved.reset();
+    valid = false;
+    generation++;
+  }
+  [[nodiscard]] bool resolved() const {
+    std::shared_lock lock(mu);
+    return valid;
+  }
+  // peek returns the cached snapshot without resolving, false when nothing is cached or it has expired
+  bool peek(value_type &value, clock::time_point now = clock::now()) const { return cached(value, now); }
+
+private:
+  bool cached(value_type &value, clock::time_point now) const {
+    std::shared_lock lock(mu);
+    if (!valid || now >= expires) {
+      return false;
+    }
+    value = saved;
+    return true;
+  }
+  mutable std::shared_mutex mu;
+  std::mutex resolving;
+  value_type saved;
+  clock::duration positiveTtl{clock::duration::max()};
+  clock::duration negativeTtl{clock::duration::max()};
+  clock::time_point expires;
+  uint64_t generation{0};
+  bool valid{false};
+};
+
+// watched_cache keeps the result of resolver() in a resolved_cache for as long as a change notification of
+// watcher.watch(changed) vouches for it. Any notification drops the result and the next get() resolves again and
+// watches again, replacing the previous watch. When nothing can be watched a result is only trusted for a while: a
+// value for positiveTtl, a missing one for negativeTtl; every get() that resolves tries to watch once more. Resolver
+// returns std::optional<T>, Watcher has bool watch(std::function<void()>) and outlives the cache.
+template <typename Resolver, typename Watcher> class watched_cache {
+public:
+  using clock = std::chrono::steady_clock;
+  using value_type = typename std::invoke_result_t<Resolver &>::value_type;
+  static constexpr clock::duration default_positive_ttl = std::chrono::seconds(60);
+  static constexpr clock::duration default_negative_ttl = std::chrono::seconds(10);
+  watched_cache(Resolver resolver_, Watcher &watcher_, clock::duration positiveTtl = default_positive_ttl,
+                clock::duration negativeTtl = default_negative_ttl)
+      : resolver(std::move(resolver_)), watcher(watcher_), unwatched(positiveTtl, negativeTtl) {}
+  watched_cache(const watched_cache &) = delete;
+  watched_cache &operator=(const watched_cache &) = delete;
+  std::shared_ptr<const value_type> get() {
+    std::shared_ptr<const value_type> value;
+    if (!armed && unwatched.peek(value)) {
+      return value;
+    }
+    if (arm()) {
+      return cache.get(resolver);
+    }
+    // no change notification available, the result is only kept until it expires
+    return unwatched.get(resolver);
+  }
+  // peek never resolves, false when nothing has been resolved yet
+  bool peek(std::shared_ptr<const value_type> &value) const { return cache.peek(value) || unwatched.peek(value); }
+  void invalidate() {
+    armed = false;
+    cache.invalidate();
+    unwatched.invalidate();
+  }
+
+private:
+  // arm watches unless a watch is registered already, concurrent callers arm once
+  bool arm() {
+    if (armed) {
+      return true;
+    }
+    std::lock_guard lock(arming);
+    if (!armed && watcher.watch([this] { invalidate(); })) {
+      armed = true;
+      unwatched.invalidate();
+    }
+    return armed;
+  }
+  Resolver resolver;
+  Watcher &watcher;
+  resolved_cache<value_type> cache;
+  resolved_cache<value_type> unwatched;
+  std::mutex arming;
+  std::atomic_bool armed{false};
+};
+
+} // namespace winmenu
+
+#endif
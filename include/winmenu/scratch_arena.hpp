@@ -0,0 +1,40 @@
+// Per-invocation scratch memory
+#ifndef WINMENU_SCRATCH_ARENA_HPP
+#define WINMENU_SCRATCH_ARENA_HPP
+#include <cstddef>
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+
+namespace winmenu {
+
+// scratch_arena holds the transient strings of one invocation: selection paths and the views over them. It is a
+// monotonic buffer, nothing is freed until the arena goes out of scope, then everything at once. The first
+// initial_size bytes live in the arena itself (on the stack of Invoke), larger selections grow into heap chunks of
+// geometrically increasing size.
+class scratch_arena {
+public:
+  static constexpr size_t initial_size = 8192;
+  scratch_arena() = default;
+  scratch_arena(const scratch_arena &) = delete;
+  scratch_arena &operator=(const scratch_arena &) = delete;
+  // resource is the allocator of containers that live no longer than the arena
+  std::pmr::memory_resource *resource() { return &mr; }
+  // copy returns a null-terminated copy of s carved from the arena
+  std::wstring_view copy(std::wstring_view s) {
+    auto p = static_cast<wchar_t *>(mr.allocate((s.size() + 1) * sizeof(wchar_t), alignof(wchar_t)));
+    if (!s.empty()) {
+      std::memcpy(p, s.data(), s.size() * sizeof(wchar_t));
+    }
+    p[s.size()] = 0;
+    return {p, s.size()};
+  }
+
+private:
+  alignas(std::max_align_t) std::byte initial[initial_size];
+  std::pmr::monotonic_buffer_resource mr{initial, sizeof(initial)};
+};
+
+} // namespace winmenu
+
+#endif
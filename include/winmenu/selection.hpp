@@ -0,0 +1,59 @@
+// Selection classification
+#ifndef WINMENU_SELECTION_HPP
+#define WINMENU_SELECTION_HPP
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include "platform.hpp"
+
+namespace winmenu {
+// item attributes share their values with SFGAO_*
+constexpr uint32_t item_folder = 0x20000000;     // SFGAO_FOLDER
+constexpr uint32_t item_filesystem = 0x40000000; // SFGAO_FILESYSTEM
+constexpr uint32_t item_classified = item_folder | item_filesystem;
+
+struct selection_facts {
+  size_t count{0};
+  bool filesystem{false};    // every item is a file system item
+  bool directory{false};     // every item is a folder
+  bool any_directory{false}; // at least one item is a folder
+  bool background{false};    // nothing is selected, the item is the folder behind the view
+};
+
+// classify_selection fetches the attributes of all items at once, nullopt for an empty selection
+std::optional<selection_facts> classify_selection(shell_item_list &items);
+
+// selection_classifier keeps the classification of the current selection for the lifetime of a menu, so GetState,
+// Invoke and friends do not ask for attributes again. The key is only compared: hold() runs under the lock whenever a
+// new selection is classified and must keep it alive, so its address cannot be reused while it is cached.
+class selection_classifier {
+public:
+  selection_classifier() = default;
+  selection_classifier(const selection_classifier &) = delete;
+  selection_classifier &operator=(const selection_classifier &) = delete;
+  template <typename Hold>
+  std::optional<selection_facts> classify(const void *key, shell_item_list &items, Hold &&hold) {
+    std::lock_guard lock(mu);
+    if (!valid || current != key) {
+      hold();
+      facts = classify_selection(items);
+      current = key;
+      valid = true;
+    }
+    return facts;
+  }
+  std::optional<selection_facts> classify(const void *key, shell_item_list &items) {
+    return classify(key, items, [] {});
+  }
+  void reset();
+
+private:
+  std::mutex mu;
+  const void *current{nullptr};
+  bool valid{false};
+  std::optional<selection_facts> facts;
+};
+
+} // namespace winmenu
+
+#endif
@@ -0,0 +1,100 @@
+// Fixed size lock-free pool of object storage
+#ifndef WINMENU_STORAGE_POOL_HPP
+#define WINMENU_STORAGE_POOL_HPP
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace winmenu {
+
+// storage_pool recycles the memory of objects of type T, not the objects: every object is destroyed and constructed as
+// usual, only its block comes from a slot instead of the heap. Released blocks are parked in capacity slots and handed
+// out again before the heap is asked for more. A slot only ever holds a whole block that a single exchange takes out,
+// there is no linked list to be torn by ABA, allocate and deallocate never block. Classes opt in through their
+// operator new/delete and must only be created with new: a block allocated elsewhere (WRL Make) would be parked here
+// and freed with the wrong alignment.
+template <typename T, size_t capacity> class storage_pool {
+public:
+  struct statistics {
+    uint64_t heap{0};     // blocks taken from the heap
+    uint64_t recycled{0}; // blocks taken from a slot
+    uint64_t dropped{0};  // blocks returned to the heap because every slot was taken
+    size_t cached{0};     // blocks parked in slots
+    // recycle_rate is the share of allocations served without the heap
+    [[nodiscard]] double recycle_rate() const {
+      auto total = heap + recycled;
+      return total == 0 ? 0 : static_cast<double>(recycled) / static_cast<double>(total);
+    }
+  };
+  storage_pool() = default;
+  storage_pool(const storage_pool &) = delete;
+  storage_pool &operator=(const storage_pool &) = delete;
+  ~storage_pool() {
+    for (auto &s : slots) {
+      if (auto p = s.exchange(nullptr, std::memory_order_acquire); p != nullptr) {
+        ::operator delete(p, std::align_val_t{alignof(T)});
+      }
+    }
+  }
+  // allocate returns storage for one T, nullptr when the heap is exhausted. recycled tells where it came from.
+  void *allocate(bool *recycled = nullptr) noexcept {
+    for (auto &s : slots) {
+      if (s.load(std::memory_order_relaxed) == nullptr) {
+        continue;
+      }
+      if (auto p = s.exchange(nullptr, std::memory_order_acquire); p != nullptr) {
+        counters.recycled.fetch_add(1, std::memory_order_relaxed);
+        if (recycled != nullptr) {
+          *recycled = true;
+        }
+        return p;
+      }
+    }
+    counters.heap.fetch_add(1, std::memory_order_relaxed);
+    if (recycled != nullptr) {
+      *recycled = false;
+    }
+    return ::operator new(sizeof(T), std::align_val_t{alignof(T)}, std::nothrow);
+  }
+  void deallocate(void *p) noexcept {
+    if (p == nullptr) {
+      return;
+    }
+    for (auto &s : slots) {
+      void *expected = nullptr;
+      if (s.load(std::memory_order_relaxed) == nullptr &&
+          s.compare_exchange_strong(expected, p, std::memory_order_release, std::memory_order_relaxed)) {
+        return;
+      }
+    }
+    counters.dropped.fetch_add(1, std::memory_order_relaxed);
+    ::operator delete(p, std::align_val_t{alignof(T)});
+  }
+  // snapshot reads the counters; with allocations in flight the fields are not taken at the same instant
+  [[nodiscard]] statistics snapshot() const {
+    statistics st;
+    st.heap = counters.heap.load(std::memory_order_relaxed);
+    st.recycled = counters.recycled.load(std::memory_order_relaxed);
+    st.dropped = counters.dropped.load(std::memory_order_relaxed);
+    for (const auto &s : slots) {
+      if (s.load(std::memory_order_relaxed) != nullptr) {
+        st.cached++;
+      }
+    }
+    return st;
+  }
+
+private:
+  static_assert(capacity > 0);
+  std::atomic<void *> slots[capacity]{};
+  struct {
+    std::atomic<uint64_t> heap{0};
+    std::atomic<uint64_t> recycled{0};
+    std::atomic<uint64_t> dropped{0};
+  } counters;
+};
+
+} // namespace winmenu
+
+#endif
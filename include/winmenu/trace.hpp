@@ -0,0 +1,160 @@
+// Hot path tracing
+#ifndef WINMENU_TRACE_HPP
+#define WINMENU_TRACE_HPP
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <vector>
+
+namespace winmenu {
+
+// trace_callback names the IExplorerCommand entry points
+enum class trace_callback : uint16_t {
+  get_title,
+  get_icon,
+  get_tooltip,
+  get_canonical_name,
+  get_state,
+  invoke,
+  get_flags,
+  enum_sub_commands,
+  count_
+};
+
+enum class trace_counter : uint16_t {
+  registry_read,
+  filesystem_probe,
+  launch_succeeded,
+  launch_failed,
+  launch_coalesced,
+  cache_hit,
+  cache_miss,
+  command_line_bytes,
+  storage_allocated,
+  storage_recycled,
+  count_
+};
+
+enum class trace_kind : uint16_t { callback = 1, counter = 2 };
+
+// trace_record is a fixed size POD, it is written to ring files as is
+struct trace_record {
+  uint64_t timestamp{0}; // nanoseconds since the Unix epoch
+  uint64_t duration{0};  // nanoseconds, callbacks only
+  trace_kind kind{trace_kind::callback};
+  uint16_t id{0};    // trace_callback or trace_counter
+  uint32_t value{0}; // counter increment
+};
+static_assert(sizeof(trace_record) == 24);
+
+const char *trace_callback_name(trace_callback c);
+const char *trace_counter_name(trace_counter c);
+
+class trace_sink {
+public:
+  virtual ~trace_sink() = default;
+  // record may be called concurrently from any thread
+  virtual void record(const trace_record &r) = 0;
+};
+
+struct metrics_block;
+class metrics;
+
+// tracer aggregates latency histograms and counters in a metrics_block and forwards every event to the installed
+// sinks. Without sinks an event costs a clock read and a few relaxed atomic increments; a sink that is only sometimes
+// listening (an ETW provider without a session) should be added and removed as it starts and stops.
+class tracer {
+public:
+  using clock = std::chrono::steady_clock;
+  class scope {
+  public:
+    scope(tracer &t_, trace_callback c_) : t(t_), c(c_), start(clock::now()) {}
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+    ~scope() { t.callback(c, clock::now() - start); }
+
+  private:
+    tracer &t;
+    trace_callback c;
+    clock::time_point start;
+  };
+  tracer();
+  ~tracer();
+  tracer(const tracer &) = delete;
+  tracer &operator=(const tracer &) = delete;
+
+  // time returns a guard recording the latency of callback c when it goes out of scope
+  [[nodiscard]] scope time(trace_callback c) { return scope(*this, c); }
+  void callback(trace_callback c, clock::duration elapsed);
+  void count(trace_counter c, uint64_t n = 1);
+  void add_sink(std::shared_ptr<trace_sink> sink);
+  void remove_sink(const trace_sink *sink);
+  void clear_sinks();
+
+  // attach moves aggregation to an initialized block that outlives the tracer, typically one shared with a scraper.
+  // What was recorded so far is carried over, increments racing with the switch may be lost.
+  void attach(metrics_block *block);
+  [[nodiscard]] metrics stats() const;
+
+private:
+  void emit(const trace_record &r);
+  std::unique_ptr<metrics_block> owned;
+  std::atomic<metrics_block *> current{nullptr};
+  std::atomic_bool hasSinks{false};
+  mutable std::shared_mutex mu;
+  std::vector<std::shared_ptr<trace_sink>> sinks;
+};
+
+// process_tracer is shared by the core adapters and the extension hosting them
+tracer &process_tracer();
+
+// ring_file_sink keeps the last capacity records in a file: a 32 byte header (magic, version, record size, capacity,
+// next sequence number) followed by capacity slots, record n lives in slot n % capacity. An existing file with a
+// matching header is continued. One process writes a file at a time. Every record is flushed before record returns,
+// deliberately: the sink runs inside Explorer, which may be killed at any moment, and a reader follows the file while
+// it is written. It is meant to be switched on while diagnosing, not left on.
+class ring_file_sink final : public trace_sink {
+public:
+  static constexpr uint64_t magic = 0x3145434152544D57; // "WMTRACE1"
+  static constexpr uint32_t version = 1;
+  explicit ring_file_sink(const std::filesystem::path &path, uint64_t capacity = 4096);
+  ~ring_file_sink() override;
+  ring_file_sink(const ring_file_sink &) = delete;
+  ring_file_sink &operator=(const ring_file_sink &) = delete;
+  [[nodiscard]] bool is_open() const { return fd != nullptr; }
+  void record(const trace_record &r) override;
+
+private:
+  std::mutex mu;
+  std::FILE *fd{nullptr};
+  uint64_t capacity{0};
+  uint64_t next{0};
+};
+
+// read_trace_ring returns the records of a ring file oldest first, false when the file is not a trace ring
+bool read_trace_ring(const std::filesystem::path &path, std::vector<trace_record> &records);
+
+struct trace_summary {
+  struct latency {
+    uint64_t calls{0};
+    uint64_t total{0}; // nanoseconds
+    uint64_t p50{0};
+    uint64_t p99{0};
+    uint64_t max{0};
+  };
+  std::array<latency, static_cast<size_t>(trace_callback::count_)> callbacks;
+  std::array<uint64_t, static_cast<size_t>(trace_counter::count_)> counters{};
+};
+
+trace_summary summarize_trace(std::span<const trace_record> records);
+
+} // namespace winmenu
+
+#endif
@@ -0,0 +1,53 @@
+// Verb visibility evaluation
+#ifndef WINMENU_VERB_STATE_HPP
+#define WINMENU_VERB_STATE_HPP
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include "selection.hpp"
+
+namespace winmenu {
+
+// verb_state mirrors EXPCMDSTATE, pending maps to E_PENDING
+enum class verb_state : unsigned char { enabled, hidden, pending };
+
+// state_probe gathers what the decision needs. Only installed_cached must be cheap, the others may do IO.
+class state_probe {
+public:
+  virtual ~state_probe() = default;
+  // installed_cached answers from memory only, nullopt when the installation has not been resolved yet
+  virtual std::optional<bool> installed_cached() = 0;
+  virtual bool installed() = 0;
+  // selection returns nullopt when there is no usable target
+  virtual std::optional<selection_facts> selection() = 0;
+  // hold keeps the selection alive while a decision for it is cached, see verb_state_machine
+  virtual void hold() {}
+};
+
+// verb_state_machine implements the IExplorerCommand::GetState protocol. Without fOkToBeSlow only cached knowledge is
+// used: a missing installation hides the verb at once, a decision made for the same selection less than ttl ago is
+// repeated, anything else is pending and Explorer calls back on a background thread, where the probes run. The
+// selection key is only compared: probe.hold() runs under the lock whenever a decision for a new key is stored and must
+// keep the selection alive until the next one, so its address cannot be reused by another selection while cached.
+class verb_state_machine {
+public:
+  using clock = std::chrono::steady_clock;
+  explicit verb_state_machine(clock::duration ttl_ = std::chrono::seconds(2)) : ttl(ttl_) {}
+  verb_state_machine(const verb_state_machine &) = delete;
+  verb_state_machine &operator=(const verb_state_machine &) = delete;
+  verb_state query(const void *selectionKey, bool okToBeSlow, state_probe &probe, clock::time_point now);
+  void reset();
+
+private:
+  std::mutex mu;
+  clock::duration ttl;
+  clock::time_point evaluated;
+  const void *key{nullptr};
+  verb_state last{verb_state::pending};
+};
+
+verb_state decide_verb_state(bool installed, const std::optional<selection_facts> &facts);
+
+} // namespace winmenu
+
+#endif
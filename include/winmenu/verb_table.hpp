@@ -0,0 +1,225 @@
+// Verb table of the WinMenu shell extension
+#ifndef WINMENU_VERB_TABLE_HPP
+#define WINMENU_VERB_TABLE_HPP
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include "platform.hpp"
+#include "code_config.hpp"
+#include "git_install.hpp"
+#include "selection.hpp"
+
+namespace winmenu {
+
+// guid has the layout of the Windows GUID
+struct guid {
+  uint32_t data1{0};
+  uint16_t data2{0};
+  uint16_t data3{0};
+  uint8_t data4[8]{};
+  constexpr bool operator==(const guid &) const = default;
+};
+
+namespace guid_internal {
+consteval uint64_t hex(std::string_view s) {
+  uint64_t v = 0;
+  for (auto c : s) {
+    v <<= 4;
+    if (c >= '0' && c <= '9') {
+      v |= static_cast<uint64_t>(c - '0');
+    } else if (c >= 'a' && c <= 'f') {
+      v |= static_cast<uint64_t>(c - 'a' + 10);
+    } else if (c >= 'A' && c <= 'F') {
+      v |= static_cast<uint64_t>(c - 'A' + 10);
+    } else {
+      throw "invalid hex digit in GUID";
+    }
+  }
+  return v;
+}
+} // namespace guid_internal
+
+// make_guid parses XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX at compile time
+consteval guid make_guid(std::string_view s) {
+  if (s.size() != 36 || s[8] != '-' || s[13] != '-' || s[18] != '-' || s[23] != '-') {
+    throw "malformed GUID";
+  }
+  guid g;
+  g.data1 = static_cast<uint32_t>(guid_internal::hex(s.substr(0, 8)));
+  g.data2 = static_cast<uint16_t>(guid_internal::hex(s.substr(9, 4)));
+  g.data3 = static_cast<uint16_t>(guid_internal::hex(s.substr(14, 4)));
+  g.data4[0] = static_cast<uint8_t>(guid_internal::hex(s.substr(19, 2)));
+  g.data4[1] = static_cast<uint8_t>(guid_internal::hex(s.substr(21, 2)));
+  for (size_t i = 0; i < 6; i++) {
+    g.data4[2 + i] = static_cast<uint8_t>(guid_internal::hex(s.substr(24 + i * 2, 2)));
+  }
+  return g;
+}
+
+// item types a verb applies to, the desktop5:ItemType registrations of the package manifests
+constexpr uint32_t verb_files = 0x1;
+constexpr uint32_t verb_directories = 0x2;
+constexpr uint32_t verb_background = 0x4;
+
+// verb_applies reports whether a classified selection matches the item types, a mixed selection needs both files
+// and directories
+constexpr bool verb_applies(uint32_t items, const selection_facts &facts) {
+  if (facts.background) {
+    return (items & verb_background) != 0;
+  }
+  if (facts.directory) {
+    return (items & verb_directories) != 0;
+  }
+  if (facts.any_directory) {
+    return (items & (verb_files | verb_directories)) == (verb_files | verb_directories);
+  }
+  return (items & verb_files) != 0;
+}
+
+// verb_services holds the per-process resolvers the verbs share, one set for every verb of the module
+class verb_services {
+public:
+  virtual ~verb_services() = default;
+  // *_cached never resolve, false when nothing has been resolved yet
+  virtual bool code_cached(std::shared_ptr<const code_config> &cfg) = 0;
+  virtual std::shared_ptr<const code_config> code() = 0;
+  virtual bool git_cached(std::shared_ptr<const git_install> &gi) = 0;
+  virtual std::shared_ptr<const git_install> git() = 0;
+};
+
+// verb_target is what Invoke hands to a verb
+enum class verb_target : uint8_t {
+  selection, // every selected item
+  location   // the first selected item, or the folder behind the view
+};
+
+// verb_descriptor is a row of verb_table. A row with children is a cascading submenu: its children are indexes into
+// verb_table, materialized one by one as Explorer enumerates them, and it has no invoke. The resolver functions answer
+// for the tool the verb starts: installed_cached from memory only (nullopt when unknown), installed and icon may
+// resolve. The command comes from the resolver as well, VS Code registers a command template, git-bash.exe takes
+// --cd=<location>. Titles are string literals, so title.data() is null-terminated.
+struct verb_descriptor {
+  std::wstring_view id; // desktop5:Verb Id
+  guid clsid;
+  std::wstring_view title;
+  uint32_t items{0}; // verb_files | verb_directories | verb_background
+  verb_target target{verb_target::selection};
+  std::optional<bool> (*installed_cached)(verb_services &services){nullptr};
+  bool (*installed)(verb_services &services){nullptr};
+  bool (*icon)(verb_services &services, std::wstring &path){nullptr};
+  // invoke launches the verb for items and returns the processes launched
+  size_t (*invoke)(verb_services &services, shell_item_list &items, process_launcher &launcher){nullptr};
+  std::span<const uint8_t> children{};
+  [[nodiscard]] constexpr bool submenu() const { return !children.empty(); }
+};
+
+namespace verbs {
+std::optional<bool> code_installed_cached(verb_services &services);
+bool code_installed(verb_services &services);
+bool code_icon(verb_services &services, std::wstring &path);
+size_t code_invoke(verb_services &services, shell_item_list &items, process_launcher &launcher);
+std::optional<bool> git_installed_cached(verb_services &services);
+bool git_installed(verb_services &services);
+bool git_icon(verb_services &services, std::wstring &path);
+size_t git_invoke(verb_services &services, shell_item_list &items, process_launcher &launcher);
+std::optional<bool> git_gui_installed_cached(verb_services &services);
+bool git_gui_installed(verb_services &services);
+bool git_gui_icon(verb_services &services, std::wstring &path);
+size_t git_gui_invoke(verb_services &services, shell_item_list &items, process_launcher &launcher);
+// a submenu is shown as long as one of its children may be, the children hide themselves
+constexpr std::optional<bool> submenu_installed_cached(verb_services &) { return true; }
+constexpr bool submenu_installed(verb_services &) { return true; }
+constexpr bool submenu_icon(verb_services &, std::wstring &) { return false; }
+
+// children of the WinMenu submenu: Open Git Bash Here, Git GUI. Open with Code stays a top-level verb only, the
+// package registering the submenu would otherwise show it twice.
+inline constexpr uint8_t winmenu_children[] = {1, 2};
+} // namespace verbs
+
+// verb_table lists every verb the module serves, the CLSIDs are registered by the package manifests
+inline constexpr verb_descriptor verb_table[] = {
+    {L"OpenWithCode", make_guid("C8E3D6A9-4F99-4B8D-A399-61ABD8D4479E"), L"Open with Code",
+     verb_files | verb_directories | verb_background, verb_target::selection, verbs::code_installed_cached,
+     verbs::code_installed, verbs::code_icon, verbs::code_invoke},
+    {L"OpenGitBashDev", make_guid("C6475E81-139F-4FD9-B758-20B68BA7F60C"), L"Open Git Bash Here",
+     verb_directories | verb_background, verb_target::location, verbs::git_installed_cached, verbs::git_installed,
+     verbs::git_icon, verbs::git_invoke},
+    {L"OpenGitGui", make_guid("EBB5370F-DBEF-4E32-BB77-665A567C41E3"), L"Git GUI",
+     verb_directories | verb_background, verb_target::location, verbs::git_gui_installed_cached,
+     verbs::git_gui_installed, verbs::git_gui_icon, verbs::git_gui_invoke},
+    {L"WinMenu", make_guid("02091ABE-0ED9-408F-9067-255B4D4BA4A3"), L"WinMenu",
+     verb_files | verb_directories | verb_background, verb_target::selection, verbs::submenu_installed_cached,
+     verbs::submenu_installed, verbs::submenu_icon, nullptr, verbs::winmenu_children},
+};
+
+// find_verb returns the row registered under clsid, nullptr when there is none
+constexpr const verb_descriptor *find_verb(const guid &clsid) {
+  for (const auto &v : verb_table) {
+    if (v.clsid == clsid) {
+      return &v;
+    }
+  }
+  return nullptr;
+}
+
+namespace verb_table_internal {
+consteval bool unique_clsids() {
+  for (size_t i = 0; i < std::size(verb_table); i++) {
+    for (size_t j = i + 1; j < std::size(verb_table); j++) {
+      if (verb_table[i].clsid == verb_table[j].clsid) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+consteval bool valid_children() {
+  for (const auto &v : verb_table) {
+    for (auto i : v.children) {
+      if (i >= std::size(verb_table) || verb_table[i].submenu()) {
+        return false;
+      }
+    }
+    if (v.submenu() == (v.invoke != nullptr)) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace verb_table_internal
+static_assert(verb_table_internal::unique_clsids(), "every verb needs its own CLSID");
+static_assert(verb_table_internal::valid_children(), "submenus list leaf verbs of verb_table and have no invoke");
+
+// submenu_cursor walks the children of a submenu for IEnumExplorerCommand, nothing is built before next() hands a
+// child out
+class submenu_cursor {
+public:
+  constexpr submenu_cursor() = default;
+  constexpr explicit submenu_cursor(const verb_descriptor &menu) : children(menu.children) {}
+  // next stores up to out.size() children and moves past them, returns how many were stored
+  constexpr size_t next(std::span<const verb_descriptor *> out) {
+    size_t n = 0;
+    for (; n < out.size() && position < children.size(); n++, position++) {
+      out[n] = &verb_table[children[position]];
+    }
+    return n;
+  }
+  // skip moves past n children, false when fewer were left
+  constexpr bool skip(size_t n) {
+    auto left = children.size() - position;
+    position += n < left ? n : left;
+    return n <= left;
+  }
+  constexpr void reset() { position = 0; }
+
+private:
+  std::span<const uint8_t> children;
+  size_t position{0};
+};
+
+} // namespace winmenu
+
+#endif
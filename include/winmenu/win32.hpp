@@ -0,0 +1,155 @@
+// Windows implementations of the WinMenu core platform interfaces
+#ifndef WINMENU_WIN32_HPP
+#define WINMENU_WIN32_HPP
+#if defined(_WIN32)
+#include <vector>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <bela.hpp>
+#include <shobjidl_core.h>
+#include <wrl/client.h>
+#include <wil/resource.h>
+#include <wil/registry.h>
+#include "platform.hpp"
+#include "code_config.hpp"
+#include "git_install.hpp"
+#include "verb_state.hpp"
+#include "trace.hpp"
+#include "metrics.hpp"
+#include "verb_table.hpp"
+
+namespace winmenu::win32 {
+
+// command_state converts a verb_state to the IExplorerCommand::GetState result
+inline HRESULT command_state(verb_state state, EXPCMDSTATE *cmdState) {
+  if (state == verb_state::pending) {
+    *cmdState = ECS_DISABLED;
+    return E_PENDING;
+  }
+  *cmdState = state == verb_state::enabled ? ECS_ENABLED : ECS_HIDDEN;
+  return S_OK;
+}
+
+// tracelogging_sink writes trace records as ETW events of the WinMenu provider
+// {2F4C1B67-5E0D-4F8A-9C21-7B8E6D3A4F15}, collect them with
+//   wpr or tracelog -guid #2F4C1B67-5E0D-4F8A-9C21-7B8E6D3A4F15
+// Create registers the provider; the sink is in the tracer only while a session enables the provider, without one
+// events do not reach it at all.
+class tracelogging_sink final : public trace_sink, public std::enable_shared_from_this<tracelogging_sink> {
+public:
+  static std::shared_ptr<tracelogging_sink> Create(tracer &t);
+  ~tracelogging_sink() override;
+  tracelogging_sink(const tracelogging_sink &) = delete;
+  tracelogging_sink &operator=(const tracelogging_sink &) = delete;
+  void record(const trace_record &r) override;
+  // enable adds the sink to the tracer or removes it, called by the provider enable callback
+  void enable(bool on);
+
+private:
+  explicit tracelogging_sink(tracer &t_) : t(t_) {}
+  tracer &t;
+  std::mutex mu;
+  bool registered{false};
+  bool added{false};
+};
+
+// metrics_mapping_name names the shared memory holding the metrics of an extension: Local\WinMenu.Metrics.<tag>.<pid>
+std::wstring metrics_mapping_name(std::wstring_view tag, DWORD pid);
+// create_metrics_block creates the named mapping and initializes it, the mapping lives until the process exits
+metrics_block *create_metrics_block(const std::wstring &name);
+// open_metrics_block maps the metrics of another process read only, nullptr when it is gone or the layout differs
+const metrics_block *open_metrics_block(const std::wstring &name);
+
+// process_trace returns process_tracer() after setting it up on first use: metrics go to the shared memory named by
+// metrics_mapping_name(tag, current pid), events to TraceLogging, and to a ring_file_sink writing
+// %WINMENU_TRACE_DIR%\winmenu-<tag>-<pid>.trace when that variable is set
+tracer &process_trace(std::wstring_view tag);
+
+// to_guid and from_guid convert between the portable guid of verb_table and GUID
+static_assert(sizeof(guid) == sizeof(GUID));
+inline GUID to_guid(const guid &g) {
+  GUID r;
+  memcpy(&r, &g, sizeof(r));
+  return r;
+}
+inline guid from_guid(REFGUID g) {
+  guid r;
+  memcpy(&r, &g, sizeof(r));
+  return r;
+}
+
+HKEY registry_root_key(registry_root root);
+
+// GitForWindowsInstallPath reads InstallPath from the first of git_install_keys that exists
+std::optional<std::wstring> GitForWindowsInstallPath(bela::error_code &ec);
+
+// registry_config_source reads HKEY_CLASSES_ROOT and the process environment
+class registry_config_source final : public config_source {
+public:
+  std::optional<std::wstring> read_string(std::wstring_view key, std::wstring_view name) override;
+  std::optional<std::wstring> environment(std::wstring_view name) override;
+};
+
+// registry_code_config_watcher watches HKEY_CLASSES_ROOT\*\shell\VSCode, or *\shell until VS Code is installed
+class registry_code_config_watcher final : public code_config_watcher {
+public:
+  bool watch(std::function<void()> changed) override;
+
+private:
+  wil::unique_registry_watcher_nothrow watcher;
+};
+
+class registry_git_install_backend final : public git_install_backend {
+public:
+  std::optional<std::wstring> install_path() override;
+  bool watch(std::function<void()> changed) override;
+
+private:
+  std::vector<wil::unique_registry_watcher_nothrow> watchers;
+};
+
+class filesystem final : public filesystem_probe {
+public:
+  bool exists(std::wstring_view path) override;
+};
+
+class create_process_launcher final : public process_launcher {
+public:
+  bool launch(launch_request &request) override;
+};
+
+// submit_threadpool_work is the launch_queue executor on Windows. The callback holds a reference on the module that
+// contains it, so the DLL stays loaded until the work returns.
+bool submit_threadpool_work(std::function<void()> work);
+
+// shell_item_array adapts the IShellItemArray passed to IExplorerCommand
+class shell_item_array final : public shell_item_list {
+public:
+  explicit shell_item_array(IShellItemArray *items_) : items(items_) {}
+  size_t count() override;
+  bool path(size_t index, std::wstring &out) override;
+  bool copy_path(size_t index, scratch_arena &arena, std::wstring_view &out) override;
+  bool attributes(uint32_t mask, uint32_t &all, uint32_t &any) override;
+
+private:
+  IShellItemArray *items{nullptr};
+};
+
+// shell_item presents a single item, such as the folder behind the view, as a list
+class shell_item final : public shell_item_list {
+public:
+  explicit shell_item(IShellItem *item_) : item(item_) {}
+  size_t count() override { return item == nullptr ? 0 : 1; }
+  bool path(size_t index, std::wstring &out) override;
+  bool copy_path(size_t index, scratch_arena &arena, std::wstring_view &out) override;
+  bool attributes(uint32_t mask, uint32_t &all, uint32_t &any) override;
+
+private:
+  IShellItem *item{nullptr};
+};
+
+} // namespace winmenu::win32
+
+#endif
+#endif
@@ -62,7 +62,7 @@ $CodeAppxBuildRoot = Join-Path -Path $WD -ChildPath "code-appx"
 Remove-Item -Force -Recurse "$CodeAppxBuildRoot" -ErrorAction SilentlyContinue
 New-Item -ItemType Directory -Force "$CodeAppxBuildRoot"
 
-Copy-Item -Recurse "$WD\lib\code-unofficial-extension.dll" -Destination "$CodeAppxBuildRoot"
+Copy-Item -Recurse "$WD\lib\winmenu-extension.dll" -Destination "$CodeAppxBuildRoot"
 Copy-Item -Recurse "$SourceRoot\LICENSE" -Destination "$CodeAppxBuildRoot"
 
 Copy-Item -Recurse "$PSScriptRoot\code\code_150x150.png" -Destination "$CodeAppxBuildRoot"
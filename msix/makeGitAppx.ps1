@@ -63,7 +63,7 @@ $GitAppxBuildRoot = Join-Path -Path $WD -ChildPath "git-appx"
 Remove-Item -Force -Recurse "$GitAppxBuildRoot" -ErrorAction SilentlyContinue
 New-Item -ItemType Directory -Force "$GitAppxBuildRoot"
 
-Copy-Item -Recurse "$WD\lib\git-extension.dll" -Destination "$GitAppxBuildRoot"
+Copy-Item -Recurse "$WD\lib\winmenu-extension.dll" -Destination "$GitAppxBuildRoot"
 Copy-Item -Recurse "$SourceRoot\LICENSE" -Destination "$GitAppxBuildRoot"
 
 Copy-Item -Recurse "$PSScriptRoot\git\Assets" -Destination "$GitAppxBuildRoot"
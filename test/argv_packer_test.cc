@@ -0,0 +1,139 @@
+/// argv_packer boundaries: command lines filled to the limit, one character over, arguments that never fit
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <bela/escape_argv.hpp>
+#include <winmenu/argv_packer.hpp>
+
+namespace winmenu {
+namespace {
+
+constexpr std::wstring_view prefix = L"code.exe";
+
+// packed returns the command lines of args packed under limit, every one checked against it
+std::vector<std::wstring> packed(const std::vector<std::wstring> &args, std::wstring_view suffix, size_t limit,
+                                 size_t *skipped = nullptr) {
+  argv_packer packer(prefix, suffix, limit);
+  packer.Reserve(args.size());
+  for (const auto &a : args) {
+    if (!packer.Append(a) && skipped != nullptr) {
+      (*skipped)++;
+    }
+  }
+  auto lines = packer.Finish();
+  for (const auto &l : lines) {
+    EXPECT_LT(l.size(), limit) << "a command line must leave room for the terminating null character";
+  }
+  return lines;
+}
+
+// joined is what a single command line holding every argument looks like
+std::wstring joined(const std::vector<std::wstring> &args, std::wstring_view suffix) {
+  bela::EscapeArgv ea;
+  ea.AppendNoEscape(prefix);
+  for (const auto &a : args) {
+    ea.Append(a);
+  }
+  if (!suffix.empty()) {
+    ea.AppendNoEscape(suffix);
+  }
+  return std::wstring(ea.sv());
+}
+
+TEST(ArgvPackerTest, EmptyPacksNothing) {
+  argv_packer packer(prefix, L"");
+  EXPECT_TRUE(packer.Finish().empty());
+}
+
+TEST(ArgvPackerTest, EscapesLikeEscapeArgv) {
+  std::vector<std::wstring> args{LR"(C:\a.txt)", LR"(C:\b c.txt)", LR"(C:\dir with space\)", LR"(quote"d)", L""};
+  auto lines = packed(args, L"--", command_line_limit);
+  ASSERT_EQ(lines.size(), 1U);
+  EXPECT_EQ(lines[0], joined(args, L"--"));
+}
+
+// a command line of exactly limit - 1 characters is kept, one more character starts a second one
+TEST(ArgvPackerTest, FillsToTheLimit) {
+  for (std::wstring_view suffix : {L"", L"--reuse-window"}) {
+    std::vector<std::wstring> args{L"aaaa", L"bbbb"};
+    auto exact = joined(args, suffix).size() + 1;
+    EXPECT_EQ(packed(args, suffix, exact).size(), 1U);
+    auto lines = packed(args, suffix, exact - 1);
+    ASSERT_EQ(lines.size(), 2U);
+    EXPECT_EQ(lines[0], joined({L"aaaa"}, suffix));
+    EXPECT_EQ(lines[1], joined({L"bbbb"}, suffix));
+  }
+}
+
+// quotes and escapes count against the limit, not the raw length
+TEST(ArgvPackerTest, LimitCountsEscapedLength) {
+  std::vector<std::wstring> args{L"a b", LR"(c"d)"};
+  auto exact = joined(args, L"").size() + 1;
+  EXPECT_GT(exact, prefix.size() + 1 + 3 + 1 + 3 + 1);
+  EXPECT_EQ(packed(args, L"", exact).size(), 1U);
+  EXPECT_EQ(packed(args, L"", exact - 1).size(), 2U);
+}
+
+TEST(ArgvPackerTest, SkipsArgumentsThatNeverFit) {
+  std::vector<std::wstring> args{L"short", std::wstring(64, L'x'), L"tail"};
+  auto limit = joined({args[1]}, L"").size();
+  size_t skipped = 0;
+  auto lines = packed(args, L"", limit, &skipped);
+  EXPECT_EQ(skipped, 1U);
+  ASSERT_EQ(lines.size(), 1U);
+  EXPECT_EQ(lines[0], joined({L"short", L"tail"}, L""));
+  // the same argument fits alone one character later, arguments stay in order around it
+  skipped = 0;
+  EXPECT_EQ(packed(args, L"", limit + 1, &skipped).size(), 3U);
+  EXPECT_EQ(skipped, 0U);
+}
+
+// many paths under the real limit: every path appears once, in order, and the lines are full
+TEST(ArgvPackerTest, ManyPathsUnderCreateProcessLimit) {
+  std::vector<std::wstring> args;
+  for (int i = 0; i < 4000; i++) {
+    args.emplace_back(LR"(C:\Users\dev\source\repos\project )" + std::to_wstring(i) + LR"(\file.txt)");
+  }
+  auto lines = packed(args, L"", command_line_limit);
+  ASSERT_GT(lines.size(), 1U);
+  std::wstring all(prefix);
+  for (const auto &l : lines) {
+    ASSERT_TRUE(l.starts_with(prefix));
+    all.append(l.substr(prefix.size()));
+  }
+  EXPECT_EQ(all, joined(args, L""));
+  for (size_t i = 0; i + 1 < lines.size(); i++) {
+    EXPECT_GT(lines[i].size() + 60, command_line_limit);
+  }
+}
+
+TEST(ArgvPackerTest, ReusableAfterFinish) {
+  argv_packer packer(prefix, L"");
+  packer.Append(L"a");
+  EXPECT_EQ(packer.Finish().size(), 1U);
+  packer.Append(L"b");
+  auto lines = packer.Finish();
+  ASSERT_EQ(lines.size(), 1U);
+  EXPECT_EQ(lines[0], L"code.exe b");
+}
+
+// lines shorter and longer than the small string buffer are sized exactly, in both character types
+TEST(ArgvPackerTest, LinesAroundTheSmallStringBuffer) {
+  for (size_t n = 0; n < 40; n++) {
+    std::wstring warg(n, L'w');
+    basic_argv_packer<wchar_t> wpacker(L"x", L"");
+    wpacker.Append(warg);
+    auto wlines = wpacker.Finish();
+    ASSERT_EQ(wlines.size(), 1U);
+    EXPECT_EQ(wlines[0], n == 0 ? std::wstring(LR"(x "")") : L"x " + warg);
+    std::string arg(n, 'a');
+    basic_argv_packer<char> packer("x", "");
+    packer.Append(arg);
+    auto lines = packer.Finish();
+    ASSERT_EQ(lines.size(), 1U);
+    EXPECT_EQ(lines[0], n == 0 ? std::string(R"(x "")") : "x " + arg);
+  }
+}
+
+} // namespace
+} // namespace winmenu
@@ -0,0 +1,158 @@
+/// code_config_cache against a fake registry that fires change notifications
+#include <gtest/gtest.h>
+#include <winmenu/code_config.hpp>
+#include "fakes.hpp"
+
+namespace winmenu {
+namespace {
+
+constexpr std::wstring_view shell_key = LR"(*\shell)";
+constexpr std::wstring_view user_code = LR"("C:\Users\dev\AppData\Local\Programs\Microsoft VS Code\Code.exe" "%1")";
+constexpr std::wstring_view system_code = LR"("C:\Program Files\Microsoft VS Code\Code.exe" "%1")";
+
+// fake_code_watcher watches like registry_code_config_watcher: the VSCode key with its subkeys, or *\shell until the
+// key exists. An unwatchable watcher stands for a registry that refuses notifications.
+class fake_code_watcher final : public code_config_watcher {
+public:
+  explicit fake_code_watcher(fake_registry &registry_, bool watchable_ = true)
+      : registry(registry_), watchable(watchable_) {}
+  ~fake_code_watcher() override { registry.unwatch(id); }
+  bool watch(std::function<void()> changed) override {
+    arms++;
+    registry.unwatch(std::exchange(id, 0));
+    if (!watchable) {
+      return false;
+    }
+    id = registry.watch(code_shell_key, true, changed);
+    if (id == 0) {
+      id = registry.watch(shell_key, false, changed);
+    }
+    return id != 0;
+  }
+  size_t arms{0};
+
+private:
+  fake_registry &registry;
+  bool watchable{true};
+  size_t id{0};
+};
+
+std::wstring render(const code_config &cfg) {
+  std::wstring cmdline;
+  cfg.command.Render({LR"(C:\src\a.txt)", LR"(C:\src)", {}}, cmdline);
+  return cmdline;
+}
+
+class CodeConfigCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    // other verbs keep *\shell around while VS Code is not installed
+    registry.write(LR"(*\shell\other\command)", L"", LR"(other.exe "%1")");
+  }
+  void install(std::wstring_view command) {
+    registry.write(code_command_key, L"", command);
+    registry.write(code_shell_key, L"Icon", LR"(C:\Program Files\Microsoft VS Code\Code.exe)");
+  }
+  fake_registry registry;
+};
+
+TEST_F(CodeConfigCacheTest, ResolvesOnce) {
+  install(system_code);
+  fake_code_watcher watcher(registry);
+  code_config_cache cache(registry, watcher);
+  std::shared_ptr<const code_config> cfg;
+  EXPECT_FALSE(cache.peek(cfg));
+  auto first = cache.get();
+  ASSERT_TRUE(first);
+  auto reads = registry.read_count();
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(cache.get(), first);
+  }
+  EXPECT_EQ(registry.read_count(), reads);
+  EXPECT_TRUE(cache.peek(cfg));
+  EXPECT_EQ(cfg, first);
+  EXPECT_TRUE(registry.watched(code_shell_key, true));
+}
+
+TEST_F(CodeConfigCacheTest, CommandChangeInvalidates) {
+  install(user_code);
+  fake_code_watcher watcher(registry);
+  code_config_cache cache(registry, watcher);
+  ASSERT_TRUE(cache.get());
+  EXPECT_EQ(render(*cache.get()),
+            LR"("C:\Users\dev\AppData\Local\Programs\Microsoft VS Code\Code.exe" "C:\src\a.txt")");
+  registry.write(code_command_key, L"", system_code);
+  std::shared_ptr<const code_config> cfg;
+  EXPECT_FALSE(cache.peek(cfg));
+  ASSERT_TRUE(cache.get());
+  EXPECT_EQ(render(*cache.get()), LR"("C:\Program Files\Microsoft VS Code\Code.exe" "C:\src\a.txt")");
+}
+
+// VS Code installed after the first menu: the watch on *\shell must move to the VSCode key, otherwise later changes
+// of its command (an update moving Code.exe, a user/system reinstall) are never seen
+TEST_F(CodeConfigCacheTest, InstallAfterStart) {
+  fake_code_watcher watcher(registry);
+  code_config_cache cache(registry, watcher);
+  EXPECT_EQ(cache.get(), nullptr);
+  EXPECT_TRUE(registry.watched(shell_key, false));
+  std::shared_ptr<const code_config> cfg;
+  EXPECT_TRUE(cache.peek(cfg));
+
+  install(user_code);
+  EXPECT_FALSE(cache.peek(cfg));
+  ASSERT_TRUE(cache.get());
+  EXPECT_TRUE(registry.watched(code_shell_key, true));
+  EXPECT_FALSE(registry.watched(shell_key, false));
+  EXPECT_EQ(registry.watch_count(), 1U);
+
+  registry.write(code_command_key, L"", system_code);
+  EXPECT_FALSE(cache.peek(cfg));
+  ASSERT_TRUE(cache.get());
+  EXPECT_EQ(render(*cache.get()), LR"("C:\Program Files\Microsoft VS Code\Code.exe" "C:\src\a.txt")");
+}
+
+TEST_F(CodeConfigCacheTest, UninstallAndReinstall) {
+  install(user_code);
+  fake_code_watcher watcher(registry);
+  code_config_cache cache(registry, watcher);
+  ASSERT_TRUE(cache.get());
+  registry.remove(code_shell_key);
+  EXPECT_EQ(cache.get(), nullptr);
+  EXPECT_TRUE(registry.watched(shell_key, false));
+  install(system_code);
+  ASSERT_TRUE(cache.get());
+  EXPECT_EQ(render(*cache.get()), LR"("C:\Program Files\Microsoft VS Code\Code.exe" "C:\src\a.txt")");
+  EXPECT_EQ(registry.watch_count(), 1U);
+}
+
+TEST_F(CodeConfigCacheTest, FailedLaunchResolvesAgain) {
+  install(user_code);
+  fake_code_watcher watcher(registry);
+  code_config_cache cache(registry, watcher);
+  auto first = cache.get();
+  ASSERT_TRUE(first);
+  cache.invalidate();
+  auto second = cache.get();
+  ASSERT_TRUE(second);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(watcher.arms, 2U);
+}
+
+// without notifications a missing VS Code is probed again once the negative entry expires, an installed one is kept
+TEST_F(CodeConfigCacheTest, UnwatchedUsesTtl) {
+  fake_code_watcher watcher(registry, false);
+  code_config_cache cache(registry, watcher, std::chrono::hours(1), std::chrono::seconds(0));
+  EXPECT_EQ(cache.get(), nullptr);
+  install(user_code);
+  auto cfg = cache.get();
+  ASSERT_TRUE(cfg);
+  auto reads = registry.read_count();
+  registry.write(code_command_key, L"", system_code);
+  auto again = cache.get();
+  ASSERT_TRUE(again);
+  EXPECT_EQ(render(*again), render(*cfg));
+  EXPECT_EQ(registry.read_count(), reads);
+}
+
+} // namespace
+} // namespace winmenu
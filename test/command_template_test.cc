@@ -0,0 +1,91 @@
+/// bela::command_template compile, render and the split around the item placeholder
+#include <string>
+#include <string_view>
+#include <gtest/gtest.h>
+#include <bela/command_template.hpp>
+
+namespace {
+
+auto resolver = [](std::wstring_view name, std::wstring &out) {
+  if (name != L"LOCALAPPDATA") {
+    return false;
+  }
+  out.append(LR"(C:\Users\dev\AppData\Local)");
+  return true;
+};
+
+TEST(CommandTemplateTest, RenderSubstitutesPlaceholders) {
+  bela::command_template t;
+  t.Compile(LR"("%LOCALAPPDATA%\Code.exe" "%1" --cd "%W" %2 %UNDEFINED%)", resolver);
+  std::wstring out;
+  t.Render({LR"(C:\src\a.txt)", LR"(C:\src)", {}}, out);
+  EXPECT_EQ(out, LR"("C:\Users\dev\AppData\Local\Code.exe" "C:\src\a.txt" --cd "C:\src"  %UNDEFINED%)");
+  EXPECT_EQ(t.RenderedSize({LR"(C:\src\a.txt)", LR"(C:\src)", {}}), out.size());
+}
+
+TEST(CommandTemplateTest, RenderPartsAroundItem) {
+  std::wstring_view items[] = {LR"(C:\a)", LR"(C:\b c)"};
+  for (std::wstring_view text : {LR"("C:\Code.exe" "%1" --new)", LR"("C:\Code.exe" %* --new)",
+                                 LR"("C:\Code.exe" "%V" --new)", LR"("C:\Code.exe" %L --new)"}) {
+    bela::command_template t;
+    t.Compile(text);
+    std::wstring prefix;
+    std::wstring suffix;
+    ASSERT_TRUE(t.RenderParts({{}, {}, items}, prefix, suffix)) << text.size();
+    EXPECT_EQ(prefix, LR"("C:\Code.exe")");
+    EXPECT_EQ(suffix, L"--new");
+  }
+}
+
+// a template with several item placeholders cannot be split once, none of them may be dropped or rendered in a part
+TEST(CommandTemplateTest, RenderPartsRejectsSeveralItems) {
+  std::wstring_view items[] = {LR"(C:\a)", LR"(C:\b)"};
+  for (std::wstring_view text :
+       {LR"(x.exe "%1" "%1")", LR"(x.exe %* "%1")", LR"(x.exe "%1" %*)", LR"(x.exe %L %V)", LR"(x.exe %* %*)"}) {
+    bela::command_template t;
+    t.Compile(text);
+    std::wstring prefix(L"untouched");
+    std::wstring suffix;
+    EXPECT_FALSE(t.RenderParts({{}, {}, items}, prefix, suffix)) << text.size();
+    EXPECT_EQ(prefix, L"untouched");
+  }
+}
+
+// an item inside a larger argument cannot take escaped items, they would split it into several arguments
+TEST(CommandTemplateTest, RenderPartsRejectsPartialArguments) {
+  std::wstring_view items[] = {LR"(C:\a)", LR"(C:\b c)"};
+  for (std::wstring_view text : {LR"(x.exe --file=%1)", LR"(x.exe "%1\sub")", LR"(x.exe "--files=%*")",
+                                 LR"(x.exe %1.bak)", LR"(x.exe "%1)", LR"(x.exe "a %1 b")", LR"(x.exe "%1"x)",
+                                 LR"(x.exe "a"%1)"}) {
+    bela::command_template t;
+    t.Compile(text);
+    std::wstring prefix;
+    std::wstring suffix;
+    EXPECT_FALSE(t.RenderParts({{}, {}, items}, prefix, suffix)) << text.size();
+    EXPECT_TRUE(prefix.empty());
+    EXPECT_TRUE(suffix.empty());
+  }
+}
+
+// a whole argument may follow quoted ones, a literal quote does not open one
+TEST(CommandTemplateTest, RenderPartsAfterQuotedArguments) {
+  std::wstring_view items[] = {LR"(C:\a)"};
+  for (std::wstring_view text : {LR"(x.exe "a b" "%1" "c d")", LR"(x.exe a\"b %1)", LR"(%1 --new)"}) {
+    bela::command_template t;
+    t.Compile(text);
+    std::wstring prefix;
+    std::wstring suffix;
+    EXPECT_TRUE(t.RenderParts({{}, {}, items}, prefix, suffix)) << text.size();
+  }
+}
+
+TEST(CommandTemplateTest, RenderPartsWithoutItem) {
+  bela::command_template t;
+  t.Compile(LR"(x.exe --cd "%W")");
+  EXPECT_FALSE(t.HasItem());
+  std::wstring prefix;
+  std::wstring suffix;
+  EXPECT_FALSE(t.RenderParts({{}, LR"(C:\)", {}}, prefix, suffix));
+}
+
+} // namespace
@@ -0,0 +1,76 @@
+/// bela::error_code messages: the std::wstring-like member, lazy system messages and readers on several threads
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <bela/base.hpp>
+
+namespace {
+
+std::wstring system_message(long code) { return *bela::system_error_message(code); }
+
+// code written against the std::wstring member still compiles and reads the same
+TEST(ErrorCodeTest, MessageReadsLikeAString) {
+  bela::error_code ec(std::wstring_view(L"unable to open key"), bela::ErrGeneral);
+  EXPECT_EQ(ec.message, L"unable to open key");
+  EXPECT_EQ(ec.message(), L"unable to open key");
+  EXPECT_EQ(std::wstring_view(ec.message).size(), ec.message.size());
+  EXPECT_STREQ(ec.message.c_str(), ec.data());
+  const std::wstring &ref = ec.message;
+  EXPECT_EQ(ref, ec.native());
+  ec.message = L"replaced";
+  EXPECT_EQ(ec.message, L"replaced");
+  ec.message = std::wstring(L"moved in");
+  EXPECT_EQ(ec.message, L"moved in");
+  ec.clear();
+  EXPECT_FALSE(ec);
+  EXPECT_TRUE(ec.message.empty());
+}
+
+TEST(ErrorCodeTest, SystemMessageIsRenderedOnRead) {
+  auto ec = bela::make_error_code_from_system(2, L"open a.txt: ");
+  EXPECT_EQ(ec.code, 2);
+  EXPECT_EQ(ec.message(), L"open a.txt: " + system_message(2));
+  auto bare = bela::make_error_code_from_system(2);
+  EXPECT_EQ(bare.message, system_message(2));
+  // errors without a prefix share the cached message
+  EXPECT_EQ(bare.message.data(), bela::make_error_code_from_system(2).data());
+}
+
+// a copy renders its own message, a move takes the rendering along
+TEST(ErrorCodeTest, CopyAndMove) {
+  auto ec = bela::make_error_code_from_system(2, L"x: ");
+  auto copy = ec;
+  EXPECT_EQ(copy.message, ec.message());
+  EXPECT_NE(copy.data(), ec.data());
+  auto rendered = ec.data();
+  auto moved = std::move(ec);
+  EXPECT_EQ(moved.data(), rendered);
+  EXPECT_EQ(moved.code, 2);
+  bela::error_code assigned(std::wstring_view(L"old"), bela::ErrGeneral);
+  assigned = copy;
+  EXPECT_EQ(assigned.code, 2);
+  EXPECT_EQ(assigned.message, L"x: " + system_message(2));
+}
+
+// threads reading the message of one error all see the same rendering
+TEST(ErrorCodeStressTest, ConcurrentReaders) {
+  for (int round = 0; round < 200; round++) {
+    auto ec = bela::make_error_code_from_system(2, L"open: ");
+    std::vector<const wchar_t *> seen(4);
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < seen.size(); t++) {
+      readers.emplace_back([&, t] { seen[t] = ec.message().data(); });
+    }
+    for (auto &r : readers) {
+      r.join();
+    }
+    for (auto p : seen) {
+      ASSERT_EQ(p, ec.data());
+    }
+    ASSERT_EQ(ec.message, L"open: " + system_message(2));
+  }
+}
+
+} // namespace
@@ -0,0 +1,205 @@
+/// bela::EscapeArgv: the SSE2/AVX2 scans against the scalar ones, the escaping rules, literals and the argv sinks
+#include <random>
+#include <string>
+#include <string_view>
+#include <iterator>
+#include <span>
+#include <vector>
+#include <gtest/gtest.h>
+#include <bela/escape_argv.hpp>
+
+namespace {
+
+// random_arg draws from the characters escaping cares about and a filler, so every SIMD lane position sees them
+template <typename charT> std::basic_string<charT> random_arg(std::mt19937 &rng, size_t length) {
+  static constexpr char alphabet[] = {'a', 'b', ' ', '\t', '"', '\\', 'z', 'a'};
+  std::uniform_int_distribution<size_t> pick(0, sizeof(alphabet) - 1);
+  std::basic_string<charT> s(length, charT('a'));
+  for (auto &c : s) {
+    c = static_cast<charT>(alphabet[pick(rng)]);
+  }
+  return s;
+}
+
+template <typename charT> void expect_scans_agree() {
+  std::mt19937 rng(20240601);
+  for (size_t length = 0; length < 130; length++) {
+    for (int round = 0; round < 20; round++) {
+      auto s = random_arg<charT>(rng, length);
+      std::basic_string_view<charT> sv(s);
+      auto scalar = bela::argv_internal::classify_scalar(sv.data(), sv.size());
+      auto ec = bela::argv_internal::classify(sv);
+      ASSERT_EQ(ec.specials, scalar.specials) << length;
+      ASSERT_EQ(ec.quotes, scalar.quotes) << length;
+      ASSERT_EQ(ec.hasspace, scalar.hasspace) << length;
+      ASSERT_EQ(bela::argv_internal::find_quote(sv), bela::argv_internal::find_quote_scalar(sv.data(), sv.size()));
+    }
+  }
+  // long enough for the lane counters to be summed several times, every lane matching in every block
+  std::basic_string<charT> quotes(10000, charT('"'));
+  auto ec = bela::argv_internal::classify(std::basic_string_view<charT>(quotes));
+  EXPECT_EQ(ec.quotes, quotes.size());
+  EXPECT_EQ(ec.specials, quotes.size());
+}
+
+TEST(EscapeArgvTest, ScansAgreeWithScalar) {
+  expect_scans_agree<char>();
+  expect_scans_agree<wchar_t>();
+  expect_scans_agree<char16_t>();
+}
+
+TEST(EscapeArgvTest, EscapingRules) {
+  bela::EscapeArgv ea;
+  ea.Append(L"plain").Append(L"").Append(L"a b").Append(LR"(a"b)").Append(LR"(C:\dir with space\)");
+  ea.Append(LR"(a\\"b)").Append(LR"(C:\no\space\)");
+  EXPECT_EQ(ea.sv(), LR"(plain "" "a b" a\"b "C:\dir with space\\" a\\\\\"b C:\no\space\)");
+}
+
+// escaped_size is exact, escape_to writes exactly that many characters
+TEST(EscapeArgvTest, EscapedSizeIsExact) {
+  std::mt19937 rng(7);
+  for (size_t length = 0; length < 80; length++) {
+    auto s = random_arg<wchar_t>(rng, length);
+    std::wstring out(bela::argv_internal::escaped_size(std::wstring_view(s)), L'\0');
+    auto end = bela::argv_internal::escape_to(std::wstring_view(s), out.data());
+    EXPECT_EQ(static_cast<size_t>(end - out.data()), out.size());
+    bela::EscapeArgv ea;
+    ea.Append(s);
+    EXPECT_EQ(ea.sv(), out);
+  }
+}
+
+// literals follow the runtime rules
+static_assert(bela::escape_literal<L"--cd=">().sv() == L"--cd=" && bela::escape_literal<L"--cd=">().joinable);
+static_assert(bela::escape_literal<L"">().sv() == LR"("")" && !bela::escape_literal<L"">().joinable);
+static_assert(bela::escape_literal<L"Git Bash">().sv() == LR"("Git Bash")" &&
+              !bela::escape_literal<L"Git Bash">().joinable);
+static_assert(bela::escape_literal<L"a\"b">().sv() == LR"(a\"b)");
+static_assert(bela::escape_literal<LR"(C:\a b\)">().sv() == LR"("C:\a b\\")");
+static_assert(bela::escape_literal<LR"(C:\dir\)">().sv() == LR"(C:\dir\)" &&
+              !bela::escape_literal<LR"(C:\dir\)">().joinable);
+static_assert(bela::escape_literal<"-n">().sv() == "-n" && bela::escape_literal<u"-n">().sv() == u"-n");
+
+// a literal assigned or appended as is equals the same text escaped at runtime
+TEST(EscapeArgvTest, LiteralsMatchRuntime) {
+  auto expect_same = [](const auto &literal, std::wstring_view text) {
+    bela::EscapeArgv runtime;
+    runtime.Assign(text).Append(text);
+    bela::EscapeArgv compiled;
+    compiled.Assign(literal).Append(literal);
+    EXPECT_EQ(compiled.sv(), runtime.sv()) << text.size();
+  };
+  expect_same(bela::escape_literal<L"--cd=">(), L"--cd=");
+  expect_same(bela::escape_literal<L"">(), L"");
+  expect_same(bela::escape_literal<L"Git Bash">(), L"Git Bash");
+  expect_same(bela::escape_literal<L"a\"b">(), L"a\"b");
+  expect_same(bela::escape_literal<LR"(C:\a b\)">(), LR"(C:\a b\)");
+}
+
+// AppendJoined<prefix>(value) is Append(prefix + value), in the owning builder and in the writer
+TEST(EscapeArgvTest, AppendJoinedMatchesRuntime) {
+  constexpr auto cd = bela::escape_literal<L"--cd=">();
+  std::mt19937 rng(18);
+  for (size_t length = 0; length < 80; length++) {
+    auto value = random_arg<wchar_t>(rng, length);
+    bela::EscapeArgv runtime;
+    runtime.Append(L"git-bash.exe").Append(L"--cd=" + value);
+    bela::EscapeArgv joined;
+    joined.Append(L"git-bash.exe").AppendJoined<cd>(value);
+    EXPECT_EQ(joined.sv(), runtime.sv()) << length;
+    std::wstring line;
+    bela::basic_string_sink<wchar_t> sink(line);
+    bela::basic_argv_writer<wchar_t, decltype(sink)> writer(sink);
+    writer.Append(L"git-bash.exe").AppendJoined<cd>(value);
+    EXPECT_EQ(line, runtime.sv()) << length;
+  }
+}
+
+// writer_matches_escape_argv streams random arguments through every sink and compares with basic_escape_argv
+template <typename charT> void writer_matches_escape_argv() {
+  using string_t = std::basic_string<charT>;
+  std::mt19937 rng(19);
+  for (size_t count = 0; count < 6; count++) {
+    std::vector<string_t> args;
+    for (size_t i = 0; i < count; i++) {
+      args.emplace_back(random_arg<charT>(rng, rng() % 24));
+    }
+    bela::basic_escape_argv<charT> ea;
+    for (const auto &a : args) {
+      ea.Append(a);
+    }
+    string_t line;
+    bela::basic_string_sink<charT> strings(line);
+    std::vector<charT> chars;
+    using iterator_sink = bela::basic_iterator_sink<charT, std::back_insert_iterator<std::vector<charT>>>;
+    iterator_sink iterators(std::back_inserter(chars));
+    bela::basic_fixed_buffer_sink<charT, 256> fixed;
+    {
+      bela::basic_argv_writer<charT, decltype(strings)> toString(strings);
+      bela::basic_argv_writer<charT, decltype(iterators)> toIterator(iterators);
+      bela::basic_argv_writer<charT, decltype(fixed)> toFixed(fixed);
+      for (const auto &a : args) {
+        toString.Append(a);
+        toIterator.Append(a);
+        toFixed.Append(a);
+      }
+    }
+    std::vector<std::basic_string_view<charT>> views(args.begin(), args.end());
+    // compared with == : the gtest printer of char8_t strings may be missing from a prebuilt library
+    ASSERT_TRUE(line == ea.sv()) << count;
+    EXPECT_TRUE(string_t(chars.begin(), chars.end()) == ea.sv()) << count;
+    ASSERT_FALSE(fixed.overflow());
+    EXPECT_TRUE(fixed.sv() == ea.sv()) << count;
+    EXPECT_EQ(std::char_traits<charT>::length(fixed.c_str()), ea.size());
+    EXPECT_EQ((bela::basic_argv_writer<charT, decltype(fixed)>::EscapedSize(views)), ea.size()) << count;
+  }
+}
+
+TEST(ArgvWriterTest, MatchesEscapeArgv) {
+  writer_matches_escape_argv<char>();
+  writer_matches_escape_argv<wchar_t>();
+  writer_matches_escape_argv<char8_t>();
+  writer_matches_escape_argv<char16_t>();
+}
+
+// a span sink never writes past its buffer, keeps the start of the line that fits and counts the size it needs
+TEST(ArgvWriterTest, SpanSinkOverflow) {
+  std::wstring_view args[] = {L"code.exe", L"a b", LR"(C:\src\x)"};
+  auto needed = bela::basic_argv_writer<wchar_t, bela::basic_span_sink<wchar_t>>::EscapedSize(args);
+  for (size_t capacity = 0; capacity <= needed; capacity++) {
+    std::wstring buffer(capacity + 1, L'#');
+    bela::basic_span_sink<wchar_t> sink(std::span<wchar_t>(buffer.data(), capacity));
+    {
+      bela::basic_argv_writer<wchar_t, decltype(sink)> writer(sink);
+      for (auto a : args) {
+        writer.Append(a);
+      }
+    }
+    EXPECT_EQ(sink.size(), needed) << capacity;
+    EXPECT_EQ(sink.overflow(), capacity < needed) << capacity;
+    EXPECT_EQ(sink.sv(), std::wstring_view(LR"(code.exe "a b" C:\src\x)").substr(0, capacity)) << capacity;
+    EXPECT_EQ(buffer.back(), L'#') << capacity;
+  }
+}
+
+// a fixed buffer sink that overflows reports the size to reserve, the line is then built again into a string
+TEST(ArgvWriterTest, FixedBufferOverflow) {
+  std::wstring path(40, L'p');
+  bela::basic_fixed_buffer_sink<wchar_t, 16> fixed;
+  {
+    bela::basic_argv_writer<wchar_t, decltype(fixed)> writer(fixed);
+    writer.Append(L"x.exe").Append(path);
+  }
+  EXPECT_TRUE(fixed.overflow());
+  EXPECT_EQ(fixed.size(), 6 + path.size());
+  EXPECT_EQ(fixed.sv(), L"x.exe " + path.substr(0, 10));
+  EXPECT_EQ(std::wstring_view(fixed.c_str()), fixed.sv());
+  std::wstring line;
+  line.reserve(fixed.size());
+  bela::basic_string_sink<wchar_t> sink(line);
+  bela::basic_argv_writer<wchar_t, decltype(sink)>(sink).Append(L"x.exe").Append(path);
+  EXPECT_EQ(line.size(), fixed.size());
+  EXPECT_EQ(line.capacity(), fixed.size());
+}
+
+} // namespace
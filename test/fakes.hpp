@@ -0,0 +1,267 @@
+// In-memory implementations of the WinMenu core platform interfaces
+#ifndef WINMENU_TEST_FAKES_HPP
+#define WINMENU_TEST_FAKES_HPP
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <winmenu/platform.hpp>
+#include <winmenu/selection.hpp>
+
+namespace winmenu {
+
+// fake_config_source is a registry of string values and an environment, keys compare as stored
+class fake_config_source : public config_source {
+public:
+  std::optional<std::wstring> read_string(std::wstring_view key, std::wstring_view name) override {
+    std::lock_guard lock(mu);
+    reads++;
+    auto it = values.find(std::make_pair(std::wstring(key), std::wstring(name)));
+    if (it == values.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+  std::optional<std::wstring> environment(std::wstring_view name) override {
+    std::lock_guard lock(mu);
+    auto it = variables.find(std::wstring(name));
+    if (it == variables.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+  // set stores a value, the empty name is the default value of key
+  void set(std::wstring_view key, std::wstring_view name, std::wstring_view value) {
+    std::lock_guard lock(mu);
+    values[std::make_pair(std::wstring(key), std::wstring(name))] = value;
+  }
+  void erase(std::wstring_view key, std::wstring_view name) {
+    std::lock_guard lock(mu);
+    values.erase(std::make_pair(std::wstring(key), std::wstring(name)));
+  }
+  void set_environment(std::wstring_view name, std::wstring_view value) {
+    std::lock_guard lock(mu);
+    variables[std::wstring(name)] = value;
+  }
+  size_t read_count() const {
+    std::lock_guard lock(mu);
+    return reads;
+  }
+
+protected:
+  mutable std::mutex mu;
+  std::map<std::pair<std::wstring, std::wstring>, std::wstring> values;
+  std::map<std::wstring, std::wstring> variables;
+  size_t reads{0};
+};
+
+// fake_registry adds change notifications to fake_config_source. A key exists while it or one of its subkeys holds a
+// value. A watch sees changes of its key, and of every subkey when recursive; like RegNotifyChangeKeyValue without
+// REG_NOTIFY_CHANGE_NAME on subkeys it also sees direct subkeys being created or deleted. A watch whose key is deleted
+// fires once and is dropped. Callbacks run on the thread making the change.
+class fake_registry final : public fake_config_source {
+public:
+  using callback = std::function<void()>;
+  // watch returns the id of a new watch on key, 0 when key does not exist
+  size_t watch(std::wstring_view key, bool recursive, callback changed) {
+    std::lock_guard lock(mu);
+    if (!exists_locked(key)) {
+      return 0;
+    }
+    watches.emplace(++lastWatch, watch_entry{std::wstring(key), recursive, std::move(changed)});
+    return lastWatch;
+  }
+  void unwatch(size_t id) {
+    std::lock_guard lock(mu);
+    watches.erase(id);
+  }
+  size_t watch_count() const {
+    std::lock_guard lock(mu);
+    return watches.size();
+  }
+  bool watched(std::wstring_view key, bool recursive) const {
+    std::lock_guard lock(mu);
+    for (const auto &[id, w] : watches) {
+      if (w.key == key && w.recursive == recursive) {
+        return true;
+      }
+    }
+    return false;
+  }
+  // write stores a value and notifies the watches that see it
+  void write(std::wstring_view key, std::wstring_view name, std::wstring_view value) {
+    std::vector<callback> fire;
+    {
+      std::lock_guard lock(mu);
+      auto created = !exists_locked(key);
+      std::vector<bool> existed;
+      for (const auto &[id, w] : watches) {
+        existed.push_back(created && exists_locked(child_of(w.key, key)));
+      }
+      values[std::make_pair(std::wstring(key), std::wstring(name))] = value;
+      size_t i = 0;
+      for (const auto &[id, w] : watches) {
+        if (sees(w, key) || (created && is_below(w.key, key) && !existed[i])) {
+          fire.push_back(w.changed);
+        }
+        i++;
+      }
+    }
+    for (const auto &f : fire) {
+      f();
+    }
+  }
+  // remove deletes key with its subkeys
+  void remove(std::wstring_view key) {
+    std::vector<callback> fire;
+    {
+      std::lock_guard lock(mu);
+      std::erase_if(values, [&](const auto &kv) { return kv.first.first == key || is_below(key, kv.first.first); });
+      for (auto it = watches.begin(); it != watches.end();) {
+        const auto &w = it->second;
+        auto deleted = w.key == key || is_below(key, w.key);
+        if (deleted || sees(w, key) || (is_below(w.key, key) && child_of(w.key, key) == key)) {
+          fire.push_back(w.changed);
+        }
+        it = deleted ? watches.erase(it) : std::next(it);
+      }
+    }
+    for (const auto &f : fire) {
+      f();
+    }
+  }
+
+private:
+  struct watch_entry {
+    std::wstring key;
+    bool recursive{false};
+    callback changed;
+  };
+  // is_below reports whether key is a subkey of parent at any depth
+  static bool is_below(std::wstring_view parent, std::wstring_view key) {
+    return key.size() > parent.size() + 1 && key.starts_with(parent) && key[parent.size()] == L'\\';
+  }
+  // child_of returns the direct subkey of parent on the way to key, key itself when it is not below parent
+  static std::wstring_view child_of(std::wstring_view parent, std::wstring_view key) {
+    if (!is_below(parent, key)) {
+      return key;
+    }
+    auto end = key.find(L'\\', parent.size() + 1);
+    return key.substr(0, end);
+  }
+  static bool sees(const watch_entry &w, std::wstring_view key) {
+    return w.key == key || (w.recursive && is_below(w.key, key));
+  }
+  bool exists_locked(std::wstring_view key) const {
+    for (const auto &kv : values) {
+      if (kv.first.first == key || is_below(key, kv.first.first)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  std::map<size_t, watch_entry> watches;
+  size_t lastWatch{0};
+};
+
+// fake_filesystem knows the files it was told about
+class fake_filesystem final : public filesystem_probe {
+public:
+  bool exists(std::wstring_view path) override {
+    std::lock_guard lock(mu);
+    probes++;
+    return files.contains(std::wstring(path));
+  }
+  void add(std::wstring_view path) {
+    std::lock_guard lock(mu);
+    files.emplace(path);
+  }
+  void remove(std::wstring_view path) {
+    std::lock_guard lock(mu);
+    files.erase(std::wstring(path));
+  }
+  size_t probe_count() const {
+    std::lock_guard lock(mu);
+    return probes;
+  }
+
+private:
+  mutable std::mutex mu;
+  std::set<std::wstring> files;
+  size_t probes{0};
+};
+
+// fake_item_list is a selection of file system items. An item without a path is a virtual item (Control Panel).
+class fake_item_list final : public shell_item_list {
+public:
+  struct item {
+    std::wstring path;
+    uint32_t attributes{item_filesystem};
+  };
+  fake_item_list() = default;
+  fake_item_list(std::initializer_list<item> items_) : items(items_) {}
+  size_t count() override { return items.size(); }
+  bool path(size_t index, std::wstring &out) override {
+    if (index >= items.size() || items[index].path.empty()) {
+      return false;
+    }
+    out = items[index].path;
+    return true;
+  }
+  bool attributes(uint32_t mask, uint32_t &all, uint32_t &any) override {
+    attribute_calls++;
+    all = mask;
+    any = 0;
+    for (const auto &i : items) {
+      all &= i.attributes;
+      any |= i.attributes & mask;
+    }
+    return true;
+  }
+  // add_file and add_directory append a file system item
+  fake_item_list &add_file(std::wstring_view path) {
+    items.push_back({std::wstring(path), item_filesystem});
+    return *this;
+  }
+  fake_item_list &add_directory(std::wstring_view path) {
+    items.push_back({std::wstring(path), item_filesystem | item_folder});
+    return *this;
+  }
+  std::vector<item> items;
+  size_t attribute_calls{0};
+};
+
+// fake_launcher records the requests it is asked to start. It may fail them and take a while, like CreateProcessW
+// behind an antivirus scan.
+class fake_launcher final : public process_launcher {
+public:
+  bool launch(launch_request &request) override {
+    if (auto d = delay.load(); d.count() != 0) {
+      std::this_thread::sleep_for(d);
+    }
+    std::lock_guard lock(mu);
+    requests.push_back(request);
+    return !fail;
+  }
+  std::vector<launch_request> launched() const {
+    std::lock_guard lock(mu);
+    return requests;
+  }
+  std::atomic<std::chrono::milliseconds> delay{std::chrono::milliseconds(0)};
+  std::atomic_bool fail{false};
+
+private:
+  mutable std::mutex mu;
+  std::vector<launch_request> requests;
+};
+
+} // namespace winmenu
+
+#endif
@@ -0,0 +1,219 @@
+/// git_install_cache against an in-memory key store that fires change notifications
+#include <gtest/gtest.h>
+#include <winmenu/git_install.hpp>
+#include "fakes.hpp"
+
+namespace winmenu {
+namespace {
+
+constexpr std::wstring_view git_key = LR"(HKLM\SOFTWARE\GitForWindows)";
+constexpr std::wstring_view user_git_key = LR"(HKCU\SOFTWARE\GitForWindows)";
+
+std::wstring key_path(const registry_key &k) {
+  std::wstring path(k.root == registry_root::local_machine ? LR"(HKLM\)" : LR"(HKCU\)");
+  path.append(k.path);
+  return path;
+}
+
+// fake_git_backend probes and watches like registry_git_install_backend: every key in git_install_keys, or its nearest
+// existing parent until the key is created. An unwatchable backend stands for a registry that refuses notifications.
+class fake_git_backend final : public git_install_backend {
+public:
+  explicit fake_git_backend(fake_registry &registry_, bool watchable_ = true)
+      : registry(registry_), watchable(watchable_) {}
+  ~fake_git_backend() override { unwatch(); }
+  std::optional<std::wstring> install_path() override {
+    for (const auto &k : git_install_keys) {
+      if (auto path = registry.read_string(key_path(k), L"InstallPath"); path) {
+        return path;
+      }
+    }
+    return std::nullopt;
+  }
+  bool watch(std::function<void()> changed) override {
+    arms++;
+    unwatch();
+    if (!watchable) {
+      return false;
+    }
+    for (const auto &k : git_install_keys) {
+      auto subKey = key_path(k);
+      for (;;) {
+        if (auto id = registry.watch(subKey, false, changed); id != 0) {
+          ids.push_back(id);
+          break;
+        }
+        auto pos = subKey.rfind(L'\\');
+        if (pos == std::wstring::npos) {
+          unwatch();
+          return false;
+        }
+        subKey.resize(pos);
+      }
+    }
+    return true;
+  }
+  size_t arms{0};
+
+private:
+  void unwatch() {
+    for (auto id : ids) {
+      registry.unwatch(id);
+    }
+    ids.clear();
+  }
+  fake_registry &registry;
+  bool watchable{true};
+  std::vector<size_t> ids;
+};
+
+class GitInstallCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    // SOFTWARE exists in both hives whether Git is installed or not
+    registry.write(LR"(HKLM\SOFTWARE\Microsoft)", L"", L"");
+    registry.write(LR"(HKCU\SOFTWARE\Microsoft)", L"", L"");
+  }
+  void install(std::wstring_view key, std::wstring_view installPath, bool gui = true) {
+    std::wstring path(installPath);
+    fs.add(path + LR"(\git-bash.exe)");
+    if (gui) {
+      fs.add(path + LR"(\cmd\git-gui.exe)");
+    }
+    registry.write(key, L"InstallPath", installPath);
+  }
+  fake_registry registry;
+  fake_filesystem fs;
+};
+
+TEST_F(GitInstallCacheTest, ResolvesOnce) {
+  install(git_key, LR"(C:\Program Files\Git)");
+  fake_git_backend backend(registry);
+  git_install_cache cache(backend, fs);
+  std::shared_ptr<const git_install> gi;
+  EXPECT_FALSE(cache.peek(gi));
+  auto first = cache.get();
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first->install_path.sv(), LR"(C:\Program Files\Git)");
+  EXPECT_EQ(first->git_bash.sv(), LR"(C:\Program Files\Git\git-bash.exe)");
+  EXPECT_EQ(first->git_gui.sv(), LR"(C:\Program Files\Git\cmd\git-gui.exe)");
+  auto reads = registry.read_count();
+  auto probes = fs.probe_count();
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(cache.get(), first);
+  }
+  EXPECT_EQ(registry.read_count(), reads);
+  EXPECT_EQ(fs.probe_count(), probes);
+  EXPECT_TRUE(cache.peek(gi));
+  EXPECT_EQ(gi, first);
+  EXPECT_TRUE(registry.watched(git_key, false));
+  EXPECT_TRUE(registry.watched(LR"(HKCU\SOFTWARE)", false));
+}
+
+TEST_F(GitInstallCacheTest, WithoutGitGui) {
+  install(git_key, LR"(C:\Git)", false);
+  fake_git_backend backend(registry);
+  git_install_cache cache(backend, fs);
+  auto gi = cache.get();
+  ASSERT_TRUE(gi);
+  EXPECT_EQ(gi->git_bash.sv(), LR"(C:\Git\git-bash.exe)");
+  EXPECT_TRUE(gi->git_gui.empty());
+}
+
+TEST_F(GitInstallCacheTest, InstallPathChangeInvalidates) {
+  install(git_key, LR"(C:\Program Files\Git)");
+  fake_git_backend backend(registry);
+  git_install_cache cache(backend, fs);
+  auto first = cache.get();
+  ASSERT_TRUE(first);
+  install(git_key, LR"(D:\Git)");
+  std::shared_ptr<const git_install> gi;
+  EXPECT_FALSE(cache.peek(gi));
+  auto second = cache.get();
+  ASSERT_TRUE(second);
+  EXPECT_EQ(second->git_bash.sv(), LR"(D:\Git\git-bash.exe)");
+}
+
+// Git installed after the first menu: the parent watches must move to the GitForWindows key
+TEST_F(GitInstallCacheTest, InstallAfterStart) {
+  fake_git_backend backend(registry);
+  git_install_cache cache(backend, fs);
+  EXPECT_EQ(cache.get(), nullptr);
+  EXPECT_TRUE(registry.watched(LR"(HKLM\SOFTWARE)", false));
+  std::shared_ptr<const git_install> gi;
+  EXPECT_TRUE(cache.peek(gi));
+
+  install(user_git_key, LR"(C:\Users\dev\AppData\Local\Programs\Git)");
+  EXPECT_FALSE(cache.peek(gi));
+  ASSERT_TRUE(cache.get());
+  EXPECT_TRUE(registry.watched(user_git_key, false));
+
+  install(user_git_key, LR"(D:\Git)");
+  EXPECT_FALSE(cache.peek(gi));
+  auto again = cache.get();
+  ASSERT_TRUE(again);
+  EXPECT_EQ(again->install_path.sv(), LR"(D:\Git)");
+}
+
+TEST_F(GitInstallCacheTest, UninstallAndReinstall) {
+  install(git_key, LR"(C:\Program Files\Git)");
+  fake_git_backend backend(registry);
+  git_install_cache cache(backend, fs);
+  ASSERT_TRUE(cache.get());
+  registry.remove(git_key);
+  EXPECT_EQ(cache.get(), nullptr);
+  EXPECT_TRUE(registry.watched(LR"(HKLM\SOFTWARE)", false));
+  install(git_key, LR"(C:\Program Files\Git)");
+  ASSERT_TRUE(cache.get());
+  EXPECT_TRUE(registry.watched(git_key, false));
+}
+
+// the machine-wide installation wins over the per-user one
+TEST_F(GitInstallCacheTest, ProbesKeysInOrder) {
+  install(user_git_key, LR"(C:\Users\dev\Git)");
+  install(git_key, LR"(C:\Program Files\Git)");
+  fake_git_backend backend(registry);
+  git_install_cache cache(backend, fs);
+  auto gi = cache.get();
+  ASSERT_TRUE(gi);
+  EXPECT_EQ(gi->install_path.sv(), LR"(C:\Program Files\Git)");
+}
+
+// resolving the same installation again shares the interned paths
+TEST_F(GitInstallCacheTest, ResolveAgainSharesPaths) {
+  install(git_key, LR"(C:\Program Files\Git)");
+  fake_git_backend backend(registry);
+  git_install_cache cache(backend, fs);
+  auto first = cache.get();
+  ASSERT_TRUE(first);
+  cache.invalidate();
+  auto second = cache.get();
+  ASSERT_TRUE(second);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(first->git_bash, second->git_bash);
+  EXPECT_EQ(first->install_path, second->install_path);
+  EXPECT_EQ(backend.arms, 2U);
+}
+
+// without notifications a missing installation is probed again once the negative entry expires, a found one is kept
+TEST_F(GitInstallCacheTest, UnwatchedUsesTtl) {
+  fake_git_backend backend(registry, false);
+  git_install_cache cache(backend, fs, std::chrono::hours(1), std::chrono::seconds(0));
+  EXPECT_EQ(cache.get(), nullptr);
+  install(git_key, LR"(C:\Program Files\Git)");
+  auto gi = cache.get();
+  ASSERT_TRUE(gi);
+  auto reads = registry.read_count();
+  install(git_key, LR"(D:\Git)");
+  auto again = cache.get();
+  ASSERT_TRUE(again);
+  EXPECT_EQ(again->install_path.sv(), LR"(C:\Program Files\Git)");
+  EXPECT_EQ(registry.read_count(), reads);
+  // the kept result is visible to callers that never probe
+  std::shared_ptr<const git_install> peeked;
+  ASSERT_TRUE(cache.peek(peeked));
+  EXPECT_EQ(peeked, gi);
+}
+
+} // namespace
+} // namespace winmenu
@@ -0,0 +1,242 @@
+/// the invoke pipeline driven through the fake platform
+#include <gtest/gtest.h>
+#include <winmenu/invoke.hpp>
+#include <winmenu/verb_table.hpp>
+#include "fakes.hpp"
+
+namespace winmenu {
+namespace {
+
+constexpr std::wstring_view code_command = LR"("%LOCALAPPDATA%\Programs\Microsoft VS Code\Code.exe" "%1")";
+
+// register_code stores what the VS Code user installer writes
+void register_code(fake_config_source &source) {
+  source.set(code_command_key, L"", code_command);
+  source.set(code_shell_key, L"Icon", LR"(%LOCALAPPDATA%\Programs\Microsoft VS Code\Code.exe)");
+  source.set_environment(L"LOCALAPPDATA", LR"(C:\Users\dev\AppData\Local)");
+}
+
+// fake_services resolves from the fakes on every call
+class fake_services final : public verb_services {
+public:
+  fake_services(config_source &source_, git_install_backend *git_ = nullptr, filesystem_probe *fs_ = nullptr)
+      : source(source_), gitBackend(git_), fs(fs_) {}
+  bool code_cached(std::shared_ptr<const code_config> &cfg) override {
+    cfg = code();
+    return true;
+  }
+  std::shared_ptr<const code_config> code() override {
+    auto cfg = resolve_code_config(source);
+    return cfg ? std::make_shared<const code_config>(std::move(*cfg)) : nullptr;
+  }
+  bool git_cached(std::shared_ptr<const git_install> &gi) override {
+    gi = git();
+    return true;
+  }
+  std::shared_ptr<const git_install> git() override {
+    if (gitBackend == nullptr) {
+      return nullptr;
+    }
+    auto gi = resolve_git_install(*gitBackend, *fs);
+    return gi ? std::make_shared<const git_install>(std::move(*gi)) : nullptr;
+  }
+
+private:
+  config_source &source;
+  git_install_backend *gitBackend{nullptr};
+  filesystem_probe *fs{nullptr};
+};
+
+class fixed_git_backend final : public git_install_backend {
+public:
+  explicit fixed_git_backend(std::wstring_view path) : installPath(path) {}
+  std::optional<std::wstring> install_path() override { return installPath; }
+  bool watch(std::function<void()>) override { return false; }
+
+private:
+  std::wstring installPath;
+};
+
+TEST(InvokeTest, ResolveCodeConfigExpandsEnvironment) {
+  fake_config_source source;
+  register_code(source);
+  auto cfg = resolve_code_config(source);
+  ASSERT_TRUE(cfg);
+  EXPECT_EQ(cfg->icon.sv(), LR"(C:\Users\dev\AppData\Local\Programs\Microsoft VS Code\Code.exe)");
+  std::wstring cmdline;
+  cfg->command.Render({LR"(C:\src\a.txt)", LR"(C:\src)", {}}, cmdline);
+  EXPECT_EQ(cmdline, LR"("C:\Users\dev\AppData\Local\Programs\Microsoft VS Code\Code.exe" "C:\src\a.txt")");
+}
+
+// the icon is not a command: placeholders stay, only defined environment references are expanded
+TEST(InvokeTest, ResolveCodeConfigIconKeepsPercent) {
+  fake_config_source source;
+  register_code(source);
+  source.set(code_shell_key, L"Icon", LR"(%LOCALAPPDATA%\100%1\%UNDEFINED%\%LOCALAPPDATA%%%\Code.exe,0)");
+  auto cfg = resolve_code_config(source);
+  ASSERT_TRUE(cfg);
+  EXPECT_EQ(cfg->icon.sv(),
+            LR"(C:\Users\dev\AppData\Local\100%1\%UNDEFINED%\C:\Users\dev\AppData\Local%%\Code.exe,0)");
+}
+
+TEST(InvokeTest, ResolveCodeConfigRejectsCommandWithoutProgram) {
+  fake_config_source source;
+  EXPECT_FALSE(resolve_code_config(source));
+  source.set(code_command_key, L"", LR"("" "%1")");
+  EXPECT_FALSE(resolve_code_config(source));
+}
+
+TEST(InvokeTest, InvokeCodeSingleItem) {
+  fake_config_source source;
+  register_code(source);
+  auto cfg = resolve_code_config(source);
+  ASSERT_TRUE(cfg);
+  fake_item_list items;
+  items.add_file(LR"(C:\src\a b.txt)");
+  fake_launcher launcher;
+  EXPECT_EQ(invoke_code(*cfg, items, launcher, true), 1U);
+  auto launched = launcher.launched();
+  ASSERT_EQ(launched.size(), 1U);
+  EXPECT_EQ(launched[0].command_line,
+            LR"("C:\Users\dev\AppData\Local\Programs\Microsoft VS Code\Code.exe" "C:\src\a b.txt")");
+}
+
+TEST(InvokeTest, InvokeCodeBatchesSelection) {
+  fake_config_source source;
+  register_code(source);
+  auto cfg = resolve_code_config(source);
+  ASSERT_TRUE(cfg);
+  fake_item_list items;
+  items.add_file(LR"(C:\src\a.txt)").add_file(LR"(C:\src\b c.txt)").add_directory(LR"(C:\src\d)");
+  fake_launcher launcher;
+  EXPECT_EQ(invoke_code(*cfg, items, launcher, true), 1U);
+  auto launched = launcher.launched();
+  ASSERT_EQ(launched.size(), 1U);
+  EXPECT_EQ(launched[0].command_line, LR"("C:\Users\dev\AppData\Local\Programs\Microsoft VS Code\Code.exe" )"
+                                      LR"(C:\src\a.txt "C:\src\b c.txt" C:\src\d)");
+}
+
+// an item inside a larger argument cannot be batched, every item gets a command line of its own
+TEST(InvokeTest, InvokeCodeRendersPartialArgumentsPerItem) {
+  fake_config_source source;
+  register_code(source);
+  source.set(code_command_key, L"", LR"("C:\Code.exe" --file=%1)");
+  auto cfg = resolve_code_config(source);
+  ASSERT_TRUE(cfg);
+  fake_item_list items;
+  items.add_file(LR"(C:\src\a.txt)").add_file(LR"(C:\src\b.txt)");
+  fake_launcher launcher;
+  EXPECT_EQ(invoke_code(*cfg, items, launcher, true), 2U);
+  auto launched = launcher.launched();
+  ASSERT_EQ(launched.size(), 2U);
+  EXPECT_EQ(launched[0].command_line, LR"("C:\Code.exe" --file=C:\src\a.txt)");
+  EXPECT_EQ(launched[1].command_line, LR"("C:\Code.exe" --file=C:\src\b.txt)");
+}
+
+// the count comes from the launcher, rejected requests are not counted
+TEST(InvokeTest, InvokeCodeCountsAcceptedLaunches) {
+  fake_config_source source;
+  register_code(source);
+  auto cfg = resolve_code_config(source);
+  ASSERT_TRUE(cfg);
+  fake_item_list items;
+  items.add_file(LR"(C:\src\a.txt)").add_file(LR"(C:\src\b.txt)");
+  fake_launcher launcher;
+  launcher.fail = true;
+  EXPECT_EQ(invoke_code(*cfg, items, launcher, true), 0U);
+  EXPECT_EQ(invoke_code(*cfg, items, launcher, false), 0U);
+  EXPECT_EQ(launcher.launched().size(), 3U);
+  launcher.fail = false;
+  EXPECT_EQ(invoke_code(*cfg, items, launcher, false), 2U);
+}
+
+TEST(InvokeTest, InvokeCodeSkipsItemsWithoutPath) {
+  fake_config_source source;
+  register_code(source);
+  auto cfg = resolve_code_config(source);
+  ASSERT_TRUE(cfg);
+  fake_item_list items{{L"", 0}, {LR"(C:\src\a.txt)"}};
+  fake_launcher launcher;
+  EXPECT_EQ(invoke_code(*cfg, items, launcher, false), 1U);
+  EXPECT_EQ(launcher.launched().size(), 1U);
+}
+
+TEST(InvokeTest, ParentDirectory) {
+  EXPECT_EQ(parent_directory(LR"(C:\src\a.txt)"), LR"(C:\src)");
+  EXPECT_EQ(parent_directory(LR"(C:\a.txt)"), LR"(C:\)");
+  EXPECT_EQ(parent_directory(LR"(\\server\share\a)"), LR"(\\server\share)");
+  EXPECT_EQ(parent_directory(L"a.txt"), L"");
+}
+
+TEST(InvokeTest, GitBashThroughVerbTable) {
+  fake_config_source source;
+  fixed_git_backend backend(LR"(C:\Program Files\Git)");
+  fake_filesystem fs;
+  fs.add(LR"(C:\Program Files\Git\git-bash.exe)");
+  fake_services services(source, &backend, &fs);
+  const auto &verb = verb_table[1];
+  ASSERT_EQ(verb.id, L"OpenGitBashDev");
+  EXPECT_EQ(verb.installed_cached(services), std::make_optional(true));
+  EXPECT_FALSE(verbs::git_gui_installed(services));
+  std::wstring icon;
+  ASSERT_TRUE(verb.icon(services, icon));
+  EXPECT_EQ(icon, LR"(C:\Program Files\Git\git-bash.exe)");
+
+  fake_item_list items;
+  items.add_directory(LR"(C:\src\my repo)");
+  fake_launcher launcher;
+  EXPECT_EQ(verb.invoke(services, items, launcher), 1U);
+  auto launched = launcher.launched();
+  ASSERT_EQ(launched.size(), 1U);
+  EXPECT_EQ(launched[0].application, LR"(C:\Program Files\Git\git-bash.exe)");
+  EXPECT_EQ(launched[0].command_line, LR"("C:\Program Files\Git\git-bash.exe" "--cd=C:\src\my repo")");
+  EXPECT_EQ(launched[0].directory, LR"(C:\src\my repo)");
+}
+
+TEST(InvokeTest, VerbsHideWithoutInstallation) {
+  fake_config_source source;
+  fake_services services(source);
+  fake_item_list items;
+  items.add_file(LR"(C:\src\a.txt)");
+  fake_launcher launcher;
+  for (const auto &verb : verb_table) {
+    if (verb.submenu()) {
+      continue;
+    }
+    EXPECT_EQ(verb.installed_cached(services), std::make_optional(false)) << verb.id.size();
+    EXPECT_EQ(verb.invoke(services, items, launcher), 0U);
+  }
+  EXPECT_TRUE(launcher.launched().empty());
+}
+
+// every child of a submenu is a verb of its own, and none is also offered at the top level by the code package
+TEST(InvokeTest, SubmenuChildren) {
+  for (const auto &verb : verb_table) {
+    for (auto child : verb.children) {
+      ASSERT_LT(child, std::size(verb_table));
+      EXPECT_FALSE(verb_table[child].submenu());
+      EXPECT_NE(verb_table[child].id, L"OpenWithCode");
+    }
+  }
+  const auto *winmenu = find_verb(verb_table[3].clsid);
+  ASSERT_NE(winmenu, nullptr);
+  ASSERT_TRUE(winmenu->submenu());
+  EXPECT_EQ(winmenu->children.size(), 2U);
+}
+
+TEST(InvokeTest, VerbAppliesToItemTypes) {
+  fake_item_list files;
+  files.add_file(LR"(C:\a)");
+  fake_item_list mixed;
+  mixed.add_file(LR"(C:\a)").add_directory(LR"(C:\b)");
+  auto fileFacts = classify_selection(files);
+  auto mixedFacts = classify_selection(mixed);
+  ASSERT_TRUE(fileFacts && mixedFacts);
+  EXPECT_TRUE(verb_applies(verb_files, *fileFacts));
+  EXPECT_FALSE(verb_applies(verb_directories, *fileFacts));
+  EXPECT_FALSE(verb_applies(verb_directories, *mixedFacts));
+  EXPECT_TRUE(verb_applies(verb_files | verb_directories, *mixedFacts));
+}
+
+} // namespace
+} // namespace winmenu
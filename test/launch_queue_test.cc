@@ -0,0 +1,126 @@
+/// launch_queue with a fake launcher that takes a while, and with executors that defer or refuse the worker
+#include <gtest/gtest.h>
+#include <winmenu/launch_queue.hpp>
+#include "fakes.hpp"
+
+namespace winmenu {
+namespace {
+
+using namespace std::chrono_literals;
+
+launch_request make_request(std::wstring_view commandLine, std::wstring_view directory = LR"(C:\src)") {
+  return launch_request{{}, std::wstring(commandLine), std::wstring(directory)};
+}
+
+// deferred_executor keeps the work until the test runs it
+class deferred_executor {
+public:
+  launch_queue::executor get() {
+    return [this](launch_queue::work w) {
+      works.emplace_back(std::move(w));
+      return true;
+    };
+  }
+  void run() {
+    auto ws = std::move(works);
+    for (auto &w : ws) {
+      w();
+    }
+  }
+  std::vector<launch_queue::work> works;
+};
+
+TEST(LaunchQueueTest, LaunchesOffTheCallingThread) {
+  auto inner = std::make_shared<fake_launcher>();
+  inner->delay = 100ms;
+  launch_queue queue(inner);
+  auto start = std::chrono::steady_clock::now();
+  for (auto cmdline : {L"code.exe a", L"code.exe b", L"code.exe c"}) {
+    auto request = make_request(cmdline);
+    EXPECT_TRUE(queue.launch(request));
+  }
+  // the caller does not wait for the three launches
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 300ms);
+  queue.wait();
+  EXPECT_TRUE(queue.idle());
+  auto launched = inner->launched();
+  ASSERT_EQ(launched.size(), 3U);
+  EXPECT_EQ(launched[0].command_line, L"code.exe a");
+  EXPECT_EQ(launched[2].command_line, L"code.exe c");
+  auto stats = queue.stats();
+  EXPECT_EQ(stats.queued, 3U);
+  EXPECT_EQ(stats.launched, 3U);
+}
+
+// a double click while the first launch is still queued or in flight starts one process
+TEST(LaunchQueueTest, CoalescesEqualRequests) {
+  auto inner = std::make_shared<fake_launcher>();
+  inner->delay = 100ms;
+  launch_queue queue(inner);
+  auto first = make_request(L"code.exe a");
+  auto second = make_request(L"code.exe a");
+  EXPECT_TRUE(queue.launch(first));
+  EXPECT_TRUE(queue.launch(second));
+  queue.wait();
+  EXPECT_EQ(inner->launched().size(), 1U);
+  EXPECT_EQ(queue.stats().coalesced, 1U);
+  // once launched, the same request starts another process
+  auto third = make_request(L"code.exe a");
+  EXPECT_TRUE(queue.launch(third));
+  queue.wait();
+  EXPECT_EQ(inner->launched().size(), 2U);
+}
+
+// the coalescing key is the whole request: the same target in another working directory is a different launch
+TEST(LaunchQueueTest, DifferentDirectoriesAreNotCoalesced) {
+  auto inner = std::make_shared<fake_launcher>();
+  deferred_executor exec;
+  launch_queue queue(inner, {}, exec.get());
+  auto first = make_request(L"git-bash.exe", LR"(C:\src\a)");
+  auto second = make_request(L"git-bash.exe", LR"(C:\src\b)");
+  auto again = make_request(L"git-bash.exe", LR"(C:\src\a)");
+  EXPECT_TRUE(queue.launch(first));
+  EXPECT_TRUE(queue.launch(second));
+  EXPECT_TRUE(queue.launch(again));
+  ASSERT_EQ(exec.works.size(), 1U);
+  exec.run();
+  EXPECT_TRUE(queue.idle());
+  auto launched = inner->launched();
+  ASSERT_EQ(launched.size(), 2U);
+  EXPECT_EQ(launched[0].directory, LR"(C:\src\a)");
+  EXPECT_EQ(launched[1].directory, LR"(C:\src\b)");
+  EXPECT_EQ(queue.stats().coalesced, 1U);
+}
+
+TEST(LaunchQueueTest, FailuresReachTheHandler) {
+  auto inner = std::make_shared<fake_launcher>();
+  inner->fail = true;
+  std::vector<std::wstring> failed;
+  deferred_executor exec;
+  launch_queue queue(inner, [&](const launch_request &r) { failed.push_back(r.command_line); }, exec.get());
+  auto request = make_request(L"code.exe a");
+  EXPECT_TRUE(queue.launch(request));
+  exec.run();
+  ASSERT_EQ(failed.size(), 1U);
+  EXPECT_EQ(failed[0], L"code.exe a");
+  EXPECT_EQ(queue.stats().failed, 1U);
+}
+
+// without a worker the request is launched inline and launch reports its outcome
+TEST(LaunchQueueTest, RefusingExecutorDrainsInline) {
+  auto inner = std::make_shared<fake_launcher>();
+  size_t failures = 0;
+  launch_queue queue(inner, [&](const launch_request &) { failures++; }, [](launch_queue::work) { return false; });
+  auto request = make_request(L"code.exe a");
+  EXPECT_TRUE(queue.launch(request));
+  EXPECT_EQ(inner->launched().size(), 1U);
+  EXPECT_TRUE(queue.idle());
+  inner->fail = true;
+  request = make_request(L"code.exe b");
+  EXPECT_FALSE(queue.launch(request));
+  EXPECT_EQ(failures, 1U);
+  EXPECT_TRUE(queue.idle());
+}
+
+} // namespace
+} // namespace winmenu
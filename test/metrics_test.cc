@@ -0,0 +1,89 @@
+/// metrics buckets, and sharded writers racing a reader adding the shards up
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <winmenu/metrics.hpp>
+
+namespace winmenu {
+namespace {
+
+std::unique_ptr<metrics_block> make_block() {
+  auto block = std::make_unique<metrics_block>();
+  initialize_metrics_block(*block);
+  return block;
+}
+
+TEST(MetricsTest, BucketsRoundTrip) {
+  for (size_t i = 0; i + 1 < metric_buckets; i++) {
+    auto lower = metric_bucket_lower(i);
+    EXPECT_EQ(metric_bucket(lower), i);
+    EXPECT_EQ(metric_bucket(metric_bucket_lower(i + 1) - 1), i);
+  }
+  EXPECT_EQ(metric_bucket(UINT64_MAX), metric_buckets - 1);
+}
+
+TEST(MetricsTest, PercentilesAndCounters) {
+  auto block = make_block();
+  EXPECT_TRUE(metrics_block_valid(*block));
+  metrics m(block.get());
+  for (uint64_t us = 1; us <= 100; us++) {
+    m.record(trace_callback::get_state, us * 1000);
+  }
+  m.add(trace_counter::cache_hit, 5);
+  auto l = m.latency(trace_callback::get_state);
+  EXPECT_EQ(l.calls, 100U);
+  EXPECT_EQ(l.sum, 5050U);
+  EXPECT_EQ(l.percentile(0), 1U);
+  // 3 significant bits: the bucket of 50us starts at 48us
+  EXPECT_EQ(l.percentile(50), 48U);
+  EXPECT_EQ(l.percentile(100), 96U);
+  EXPECT_EQ(m.counter(trace_counter::cache_hit), 5U);
+  EXPECT_EQ(m.latency(trace_callback::invoke).calls, 0U);
+}
+
+// writers on more threads than shards never lose an increment, a reader racing them only sees totals grow
+TEST(MetricsStressTest, ConcurrentWritersAndReader) {
+  constexpr size_t writers = metric_shards * 2;
+  constexpr uint64_t iterations = 20000;
+  auto block = make_block();
+  metrics m(block.get());
+  std::atomic_bool done{false};
+  std::atomic<size_t> regressions{0};
+  std::thread reader([&] {
+    uint64_t lastCalls = 0;
+    uint64_t lastCount = 0;
+    while (!done.load(std::memory_order_acquire)) {
+      auto calls = read_latency(*block, trace_callback::invoke).calls;
+      auto count = read_counter(*block, trace_counter::command_line_bytes);
+      if (calls < lastCalls || count < lastCount) {
+        regressions++;
+      }
+      lastCalls = calls;
+      lastCount = count;
+    }
+  });
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < writers; t++) {
+    threads.emplace_back([&, t] {
+      for (uint64_t i = 0; i < iterations; i++) {
+        m.record(trace_callback::invoke, (i % 1000) * 1000);
+        m.add(trace_counter::command_line_bytes, t + 1);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  done.store(true, std::memory_order_release);
+  reader.join();
+  EXPECT_EQ(regressions.load(), 0U);
+  auto l = m.latency(trace_callback::invoke);
+  EXPECT_EQ(l.calls, writers * iterations);
+  EXPECT_EQ(l.sum, writers * (iterations / 1000) * (999 * 1000 / 2));
+  EXPECT_EQ(m.counter(trace_counter::command_line_bytes), iterations * writers * (writers + 1) / 2);
+}
+
+} // namespace
+} // namespace winmenu
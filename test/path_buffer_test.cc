@@ -0,0 +1,78 @@
+/// bela::path_buffer joins, spilling past the inline storage, the \\?\ prefix and views of the buffer written back
+#include <string>
+#include <string_view>
+#include <gtest/gtest.h>
+#include <bela/path_buffer.hpp>
+
+namespace {
+
+using small_buffer = bela::basic_path_buffer<wchar_t, 8, L'\\'>;
+
+TEST(PathBufferTest, JoinKeepsOneSeparator) {
+  bela::windows_path_buffer p(LR"(C:\Program Files\Git)");
+  p.Join(L"cmd", LR"(\git-gui.exe)");
+  EXPECT_EQ(p.sv(), LR"(C:\Program Files\Git\cmd\git-gui.exe)");
+  p.Truncate(20);
+  p.Join(L"git-bash.exe");
+  EXPECT_EQ(p.sv(), LR"(C:\Program Files\Git\git-bash.exe)");
+  EXPECT_FALSE(p.spilled());
+  bela::windows_path_buffer root(LR"(C:\)");
+  root.Join(L"x");
+  EXPECT_EQ(root.sv(), LR"(C:\x)");
+  bela::windows_path_buffer empty;
+  empty.Join(L"rel");
+  EXPECT_EQ(empty.sv(), L"rel");
+}
+
+TEST(PathBufferTest, SpillsAndMoves) {
+  small_buffer p(L"C:\\abc");
+  EXPECT_FALSE(p.spilled());
+  p.Join(L"defghijk");
+  EXPECT_TRUE(p.spilled());
+  EXPECT_EQ(p.sv(), LR"(C:\abc\defghijk)");
+  EXPECT_EQ(p.c_str()[p.size()], L'\0');
+  auto moved = std::move(p);
+  EXPECT_EQ(moved.sv(), LR"(C:\abc\defghijk)");
+  EXPECT_TRUE(p.empty());
+  small_buffer copy(moved);
+  EXPECT_EQ(copy.sv(), moved.sv());
+}
+
+TEST(PathBufferTest, MakeExtended) {
+  std::wstring name(300, L'a');
+  bela::windows_path_buffer drive(LR"(C:\)");
+  drive.Join(name);
+  drive.MakeExtended();
+  EXPECT_EQ(drive.sv(), LR"(\\?\C:\)" + name);
+  bela::windows_path_buffer unc(LR"(\\server\share)");
+  unc.Join(name);
+  unc.MakeExtended();
+  EXPECT_EQ(unc.sv(), LR"(\\?\UNC\server\share\)" + name);
+  bela::windows_path_buffer shortPath(LR"(C:\a)");
+  shortPath.MakeExtended();
+  EXPECT_EQ(shortPath.sv(), LR"(C:\a)");
+}
+
+// a view of the buffer itself survives the reallocation it causes and an overlapping copy
+TEST(PathBufferTest, SelfAliasingViews) {
+  small_buffer p(L"abcdef");
+  p.Append(p.sv());
+  EXPECT_EQ(p.sv(), L"abcdefabcdef");
+  EXPECT_TRUE(p.spilled());
+  p.Append(p.sv());
+  EXPECT_EQ(p.sv(), L"abcdefabcdefabcdefabcdef");
+  p.Assign(p.sv().substr(3, 6));
+  EXPECT_EQ(p.sv(), L"defabc");
+  small_buffer q(L"C:\\dir");
+  q.Join(q.sv().substr(3));
+  EXPECT_EQ(q.sv(), L"C:\\dir\\dir");
+  q.Join(q.sv());
+  EXPECT_EQ(q.sv(), L"C:\\dir\\dir\\C:\\dir\\dir");
+  small_buffer r(L"xyz");
+  r.Assign(r.sv());
+  EXPECT_EQ(r.sv(), L"xyz");
+  r.Join(r.sv().substr(1, 1));
+  EXPECT_EQ(r.sv(), L"xyz\\y");
+}
+
+} // namespace
@@ -0,0 +1,90 @@
+/// bela::path_fold: the SSE2/AVX2 fold, hash and compare against the scalar ones, and the case-insensitive containers
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <gtest/gtest.h>
+#include <bela/path_fold.hpp>
+
+namespace {
+
+// random_path draws ASCII letters and separators with Latin-1, Greek, Cyrillic, surrogate and sign bit code units
+// scattered so that every vector lane position sees them
+template <typename charT> std::basic_string<charT> random_path(std::mt19937 &rng, size_t length) {
+  static constexpr char32_t alphabet[] = {'a',    'Z',    'q',    '\\',   '.',    'z',    'x',    'K',    0x00E9,
+                                          0x00FF, 0x0101, 0x03B1, 0x0431, 0x0131, 0xD83D, 0xFF41, 0x8000};
+  std::uniform_int_distribution<size_t> pick(0, std::size(alphabet) - 1);
+  std::basic_string<charT> s(length, charT('a'));
+  for (auto &c : s) {
+    c = static_cast<charT>(alphabet[pick(rng)]);
+  }
+  return s;
+}
+
+// swap_case flips some ASCII letters and folds some others, the result is equal under the fold
+template <typename charT> std::basic_string<charT> swap_case(std::mt19937 &rng, std::basic_string<charT> s) {
+  std::bernoulli_distribution flip(0.5);
+  for (auto &c : s) {
+    if (!flip(rng)) {
+      continue;
+    }
+    if (c >= 'a' && c <= 'z') {
+      c = static_cast<charT>(c - 0x20);
+    } else if (c >= 'A' && c <= 'Z') {
+      c = static_cast<charT>(c + 0x20);
+    } else {
+      c = bela::fold_internal::fold_unit(c);
+    }
+  }
+  return s;
+}
+
+template <typename charT> void expect_vector_matches_scalar() {
+  namespace fi = bela::fold_internal;
+  std::mt19937 rng(20241017);
+  for (size_t length = 0; length < 100; length++) {
+    for (int round = 0; round < 20; round++) {
+      auto s = random_path<charT>(rng, length);
+      std::basic_string_view<charT> sv(s);
+      std::basic_string<charT> folded(length, charT(0));
+      fi::fold_scalar(sv.data(), sv.size(), folded.data());
+      ASSERT_EQ(bela::fold_case(sv), folded) << length;
+      ASSERT_EQ(bela::hash_fold(sv), fi::finish(fi::hash_scalar(fi::seed, sv.data(), sv.size()), sv.size())) << length;
+      auto other = swap_case(rng, s);
+      ASSERT_TRUE(bela::equal_fold(sv, other)) << length;
+      ASSERT_EQ(bela::hash_fold(sv), bela::hash_fold(std::basic_string_view<charT>(other))) << length;
+      if (length != 0) {
+        std::uniform_int_distribution<size_t> at(0, length - 1);
+        auto i = at(rng);
+        other[i] = static_cast<charT>(other[i] == '0' ? '1' : '0');
+        ASSERT_EQ(bela::equal_fold(sv, other), fi::equal_scalar(sv.data(), other.data(), length)) << length;
+        ASSERT_FALSE(bela::equal_fold(sv, other)) << length;
+      }
+    }
+  }
+}
+
+TEST(PathFoldTest, VectorMatchesScalar) {
+  expect_vector_matches_scalar<char16_t>();
+  expect_vector_matches_scalar<wchar_t>();
+  expect_vector_matches_scalar<char32_t>();
+}
+
+TEST(PathFoldTest, FoldsLikeTheFileSystem) {
+  EXPECT_EQ(bela::fold_case(std::wstring_view(L"C:\\Users\\\u00e9t\u00e9\\\u0131")),
+            L"C:\\USERS\\\u00c9T\u00c9\\\u0131");
+  EXPECT_FALSE(bela::equal_fold(std::wstring_view(L"\u0131"), L"I"));
+  // longer than the small string buffer
+  EXPECT_EQ(bela::fold_case(std::wstring_view(L"c:\\program files\\microsoft vs code")),
+            L"C:\\PROGRAM FILES\\MICROSOFT VS CODE");
+}
+
+TEST(PathFoldTest, UnorderedSetIgnoresCase) {
+  std::unordered_set<std::wstring, bela::fold_hash, bela::fold_equal> paths;
+  paths.emplace(L"C:\\Program Files\\Git\\git-bash.exe");
+  EXPECT_FALSE(paths.emplace(L"c:\\PROGRAM FILES\\git\\GIT-BASH.EXE").second);
+  EXPECT_TRUE(paths.contains(std::wstring_view(L"C:\\program files\\GIT\\git-bash.exe")));
+  EXPECT_FALSE(paths.contains(std::wstring_view(L"C:\\Program Files\\Git\\git-cmd.exe")));
+}
+
+} // namespace
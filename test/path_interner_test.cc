@@ -0,0 +1,123 @@
+/// path_interner handles, collection of unused entries, and readers racing writers that churn the table
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <bela/path_fold.hpp>
+#include <winmenu/path_interner.hpp>
+
+namespace winmenu {
+namespace {
+
+std::wstring make_path(size_t i) { return LR"(C:\Users\dev\source\repos\project)" + std::to_wstring(i); }
+
+TEST(PathInternerTest, EqualPathsShareOneEntry) {
+  path_interner interner(16);
+  auto a = interner.intern(LR"(C:\Program Files\Git)");
+  auto b = interner.intern(LR"(c:\PROGRAM FILES\git)");
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.sv(), LR"(C:\Program Files\Git)");
+  EXPECT_EQ(interner.find(LR"(C:\program files\GIT)"), a);
+  EXPECT_TRUE(interner.find(LR"(C:\Windows)").empty());
+  EXPECT_TRUE(interner.intern(L"").empty());
+  auto st = interner.snapshot();
+  EXPECT_EQ(st.misses, 1U);
+  EXPECT_EQ(st.hits, 2U);
+  EXPECT_EQ(st.entries, 1U);
+}
+
+// collect frees what nobody holds, a held handle keeps its entry and its identity
+TEST(PathInternerTest, CollectKeepsHeldEntries) {
+  path_interner interner(16);
+  auto held = interner.intern(make_path(0));
+  interner.intern(make_path(1));
+  interner.collect();
+  auto st = interner.snapshot();
+  EXPECT_EQ(st.entries, 1U);
+  EXPECT_EQ(st.reclaimed, 1U);
+  EXPECT_EQ(st.retired, 0U);
+  EXPECT_EQ(interner.intern(make_path(0)), held);
+  EXPECT_TRUE(interner.find(make_path(1)).empty());
+}
+
+// the table sweeps itself once it holds capacity entries
+TEST(PathInternerTest, TableStaysBounded) {
+  path_interner interner(32);
+  for (size_t i = 0; i < 1000; i++) {
+    interner.intern(make_path(i));
+  }
+  auto st = interner.snapshot();
+  EXPECT_LE(st.entries, 32U);
+  EXPECT_EQ(st.misses, 1000U);
+  EXPECT_GE(st.reclaimed + st.retired + st.entries, 1000U);
+}
+
+// readers intern and find paths in random case while writers churn new paths through a small table and collect it.
+// Every handle reads back the path it was asked for and a pinned handle keeps its identity throughout.
+TEST(PathInternerStressTest, ReadersAgainstChurn) {
+  constexpr size_t readers = 6;
+  constexpr size_t writers = 2;
+  constexpr size_t iterations = 3000;
+  constexpr size_t hot = 64;
+  path_interner interner(32);
+  auto pinned = interner.intern(make_path(0));
+  std::atomic<size_t> mismatches{0};
+  std::atomic_bool done{false};
+  std::vector<std::thread> threads;
+  for (size_t w = 0; w < writers; w++) {
+    threads.emplace_back([&, w] {
+      for (size_t i = 0; !done.load(std::memory_order_relaxed); i++) {
+        auto h = interner.intern(make_path(100000 * (w + 1) + i));
+        if (h.sv() != make_path(100000 * (w + 1) + i)) {
+          mismatches++;
+        }
+        if (i % 64 == 0) {
+          interner.collect();
+        }
+      }
+    });
+  }
+  std::vector<std::thread> workers;
+  for (size_t r = 0; r < readers; r++) {
+    workers.emplace_back([&, r] {
+      std::mt19937 rng(static_cast<unsigned>(r));
+      std::uniform_int_distribution<size_t> pick(0, hot - 1);
+      std::vector<interned_path> held;
+      for (size_t i = 0; i < iterations; i++) {
+        auto path = make_path(pick(rng));
+        if (rng() % 2 == 0) {
+          path = bela::fold_case(std::wstring_view(path));
+        }
+        auto h = (i % 3 == 0) ? interner.find(path) : interner.intern(path);
+        if (!h.empty() && !bela::equal_fold(h.sv(), path)) {
+          mismatches++;
+        }
+        if (interner.intern(make_path(0)) != pinned) {
+          mismatches++;
+        }
+        held.emplace_back(std::move(h));
+        if (held.size() > 8) {
+          held.erase(held.begin());
+        }
+      }
+    });
+  }
+  for (auto &t : workers) {
+    t.join();
+  }
+  done.store(true, std::memory_order_relaxed);
+  for (auto &t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(mismatches.load(), 0U);
+  EXPECT_EQ(pinned.sv(), make_path(0));
+  interner.collect();
+  auto st = interner.snapshot();
+  EXPECT_EQ(st.entries, 1U);
+  EXPECT_EQ(st.retired, 0U);
+}
+
+} // namespace
+} // namespace winmenu
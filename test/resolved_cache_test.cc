@@ -0,0 +1,179 @@
+/// resolved_cache expiry and invalidation, and watched_cache arming, against threads resolving while notifications fire
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <winmenu/resolved_cache.hpp>
+
+namespace winmenu {
+namespace {
+
+using namespace std::chrono_literals;
+
+// counting_resolver returns its current value, nothing while it is zero
+struct counting_resolver {
+  std::atomic<int> &value;
+  std::atomic<uint64_t> &calls;
+  std::optional<int> operator()() const {
+    calls.fetch_add(1, std::memory_order_relaxed);
+    auto v = value.load(std::memory_order_acquire);
+    return v == 0 ? std::nullopt : std::make_optional(v);
+  }
+};
+
+// fake_watcher keeps the last callback, fire() stands for a change notification
+class fake_watcher {
+public:
+  explicit fake_watcher(bool watchable_ = true) : watchable(watchable_) {}
+  bool watch(std::function<void()> changed_) {
+    arms.fetch_add(1, std::memory_order_relaxed);
+    if (!watchable) {
+      return false;
+    }
+    std::lock_guard lock(mu);
+    changed = std::move(changed_);
+    return true;
+  }
+  void fire() {
+    std::function<void()> callback;
+    {
+      std::lock_guard lock(mu);
+      callback = changed;
+    }
+    if (callback) {
+      callback();
+    }
+  }
+  std::atomic<size_t> arms{0};
+
+private:
+  std::mutex mu;
+  std::function<void()> changed;
+  bool watchable;
+};
+
+using int_cache = watched_cache<counting_resolver, fake_watcher>;
+
+TEST(ResolvedCacheTest, KeepsResultsForTheirTtl) {
+  resolved_cache<int> cache(10s, 1s);
+  resolved_cache<int>::clock::time_point now{};
+  int calls = 0;
+  auto missing = [&]() -> std::optional<int> {
+    calls++;
+    return std::nullopt;
+  };
+  EXPECT_EQ(cache.get(missing, now), nullptr);
+  EXPECT_EQ(cache.get(missing, now + 999ms), nullptr);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(*cache.get([] { return std::optional<int>(4); }, now + 1s), 4);
+  resolved_cache<int>::value_type value;
+  EXPECT_TRUE(cache.peek(value, now + 10s));
+  EXPECT_FALSE(cache.peek(value, now + 11s));
+}
+
+// without times to live a result never expires, even at the end of the clock
+TEST(ResolvedCacheTest, NoTtlNeverExpires) {
+  resolved_cache<int> cache;
+  auto far = resolved_cache<int>::clock::time_point::max() - 1s;
+  cache.get([] { return std::optional<int>(1); }, far);
+  resolved_cache<int>::value_type value;
+  ASSERT_TRUE(cache.peek(value, far + 999ms));
+  EXPECT_EQ(*value, 1);
+}
+
+// invalidate during a resolution discards its result, the caller still gets it
+TEST(ResolvedCacheTest, InvalidateDuringResolveDiscards) {
+  resolved_cache<int> cache;
+  auto value = cache.get([&]() -> std::optional<int> {
+    cache.invalidate();
+    return 7;
+  });
+  EXPECT_EQ(*value, 7);
+  EXPECT_FALSE(cache.peek(value));
+  EXPECT_FALSE(cache.resolved());
+}
+
+TEST(WatchedCacheTest, ArmsOnceUntilNotified) {
+  std::atomic<int> value{1};
+  std::atomic<uint64_t> calls{0};
+  fake_watcher watcher;
+  int_cache cache({value, calls}, watcher);
+  EXPECT_EQ(*cache.get(), 1);
+  EXPECT_EQ(*cache.get(), 1);
+  EXPECT_EQ(calls.load(), 1U);
+  EXPECT_EQ(watcher.arms.load(), 1U);
+  value = 2;
+  watcher.fire();
+  std::shared_ptr<const int> peeked;
+  EXPECT_FALSE(cache.peek(peeked));
+  EXPECT_EQ(*cache.get(), 2);
+  EXPECT_EQ(calls.load(), 2U);
+  EXPECT_EQ(watcher.arms.load(), 2U);
+}
+
+// a watcher that refuses notifications is asked again whenever the unwatched result has expired
+TEST(WatchedCacheTest, UnwatchedRetriesArming) {
+  std::atomic<int> value{1};
+  std::atomic<uint64_t> calls{0};
+  fake_watcher watcher(false);
+  int_cache cache({value, calls}, watcher, 1h, 0s);
+  EXPECT_EQ(*cache.get(), 1);
+  EXPECT_EQ(*cache.get(), 1);
+  EXPECT_EQ(calls.load(), 1U);
+  EXPECT_EQ(watcher.arms.load(), 1U);
+  cache.invalidate();
+  value = 0;
+  EXPECT_EQ(cache.get(), nullptr);
+  EXPECT_EQ(cache.get(), nullptr);
+  EXPECT_EQ(calls.load(), 3U);
+  EXPECT_EQ(watcher.arms.load(), 3U);
+}
+
+// threads resolve and hit while another one changes the value and fires notifications; every get returns a value the
+// resolver produced and, after the last notification, the final one
+TEST(WatchedCacheStressTest, ConcurrentGetsAndNotifications) {
+  constexpr size_t threads = 8;
+  constexpr int iterations = 4000;
+  std::atomic<int> value{1};
+  std::atomic<uint64_t> calls{0};
+  std::atomic<size_t> wrong{0};
+  std::atomic_bool done{false};
+  fake_watcher watcher;
+  int_cache cache({value, calls}, watcher);
+  std::thread notifier([&] {
+    for (int i = 2; !done.load(std::memory_order_acquire); i++) {
+      value.store(i % 5, std::memory_order_release);
+      watcher.fire();
+      std::this_thread::yield();
+    }
+  });
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([&] {
+      for (int i = 0; i < iterations; i++) {
+        if (auto v = cache.get(); v && (*v < 1 || *v > 4)) {
+          wrong++;
+        }
+      }
+    });
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  done.store(true, std::memory_order_release);
+  notifier.join();
+  EXPECT_EQ(wrong.load(), 0U);
+  EXPECT_LE(calls.load(), threads * iterations);
+  value = 3;
+  watcher.fire();
+  auto last = cache.get();
+  ASSERT_NE(last, nullptr);
+  EXPECT_EQ(*last, 3);
+}
+
+} // namespace
+} // namespace winmenu
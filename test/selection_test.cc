@@ -0,0 +1,62 @@
+/// selection classification: one batched attributes call per selection and per menu
+#include <gtest/gtest.h>
+#include <winmenu/selection.hpp>
+#include "fakes.hpp"
+
+namespace winmenu {
+namespace {
+
+TEST(SelectionTest, ClassifyFacts) {
+  fake_item_list empty;
+  EXPECT_FALSE(classify_selection(empty));
+
+  fake_item_list dirs;
+  dirs.add_directory(LR"(C:\a)").add_directory(LR"(C:\b)");
+  auto facts = classify_selection(dirs);
+  ASSERT_TRUE(facts);
+  EXPECT_EQ(facts->count, 2U);
+  EXPECT_TRUE(facts->filesystem);
+  EXPECT_TRUE(facts->directory);
+  EXPECT_TRUE(facts->any_directory);
+  EXPECT_FALSE(facts->background);
+  EXPECT_EQ(dirs.attribute_calls, 1U);
+
+  // a virtual item (Control Panel) makes the selection unusable for every verb
+  fake_item_list mixed{{LR"(C:\a.txt)"}, {L"", item_folder}};
+  facts = classify_selection(mixed);
+  ASSERT_TRUE(facts);
+  EXPECT_FALSE(facts->filesystem);
+  EXPECT_FALSE(facts->directory);
+  EXPECT_TRUE(facts->any_directory);
+}
+
+// GetState, Invoke and friends of one menu share the classification of a selection
+TEST(SelectionTest, ClassifierCachesPerSelection) {
+  fake_item_list first;
+  first.add_file(LR"(C:\a.txt)");
+  fake_item_list second;
+  second.add_directory(LR"(C:\b)");
+  selection_classifier classifier;
+  size_t holds = 0;
+  auto hold = [&] { holds++; };
+  for (int i = 0; i < 10; i++) {
+    auto facts = classifier.classify(&first, first, hold);
+    ASSERT_TRUE(facts);
+    EXPECT_FALSE(facts->directory);
+  }
+  EXPECT_EQ(first.attribute_calls, 1U);
+  EXPECT_EQ(holds, 1U);
+
+  auto facts = classifier.classify(&second, second, hold);
+  ASSERT_TRUE(facts);
+  EXPECT_TRUE(facts->directory);
+  EXPECT_EQ(holds, 2U);
+
+  classifier.reset();
+  EXPECT_TRUE(classifier.classify(&second, second, hold));
+  EXPECT_EQ(second.attribute_calls, 2U);
+  EXPECT_EQ(holds, 3U);
+}
+
+} // namespace
+} // namespace winmenu
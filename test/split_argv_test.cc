@@ -0,0 +1,80 @@
+/// bela::split_argv: the CommandLineToArgvW rules, and random arguments escaped by EscapeArgv split back unchanged
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include <bela/escape_argv.hpp>
+#include <bela/split_argv.hpp>
+
+namespace {
+
+std::vector<std::wstring> split(std::wstring_view cmdline) {
+  std::vector<std::wstring> args;
+  bela::argv_splitter splitter(cmdline);
+  bela::argv_token token;
+  while (splitter.Next(token)) {
+    auto s = token.str();
+    // an argument that is not escaped is its value, a view into the command line
+    if (!token.escaped) {
+      EXPECT_EQ(s, token.value);
+      EXPECT_GE(token.value.data(), cmdline.data());
+      EXPECT_LE(token.value.data() + token.value.size(), cmdline.data() + cmdline.size());
+    }
+    args.emplace_back(std::move(s));
+  }
+  return args;
+}
+
+using args_t = std::vector<std::wstring>;
+
+// the examples of the CommandLineToArgvW documentation, after a program name
+TEST(SplitArgvTest, CommandLineToArgvRules) {
+  EXPECT_EQ(split(LR"(x "abc" d e)"), (args_t{L"x", L"abc", L"d", L"e"}));
+  EXPECT_EQ(split(LR"(x a\\\b d"e f"g h)"), (args_t{L"x", LR"(a\\\b)", L"de fg", L"h"}));
+  EXPECT_EQ(split(LR"(x a\\\"b c d)"), (args_t{L"x", LR"(a\"b)", L"c", L"d"}));
+  EXPECT_EQ(split(LR"(x a\\\\"b c" d e)"), (args_t{L"x", LR"(a\\b c)", L"d", L"e"}));
+  EXPECT_EQ(split(LR"(x a"b"" c d)"), (args_t{L"x", LR"(ab")", L"c", L"d"}));
+  EXPECT_EQ(split(L"x \"\" \t\"a\"\"\"b\" "), (args_t{L"x", L"", LR"(a"b)"}));
+}
+
+// the program name ends at the next quote and keeps its backslashes
+TEST(SplitArgvTest, ProgramName) {
+  EXPECT_EQ(split(LR"("C:\Program Files\Code.exe" "%1")"), (args_t{LR"(C:\Program Files\Code.exe)", L"%1"}));
+  EXPECT_EQ(split(LR"("C:\dir\"x)"), (args_t{LR"(C:\dir\)", L"x"}));
+  EXPECT_EQ(split(LR"(C:\a\"b" c)"), (args_t{LR"(C:\a\"b")", L"c"}));
+  EXPECT_EQ(split(LR"("" x)"), (args_t{L"", L"x"}));
+  EXPECT_TRUE(split(L"").empty());
+}
+
+TEST(SplitArgvTest, SpanReportsEveryArgument) {
+  bela::argv_token tokens[2];
+  EXPECT_EQ(bela::split_argv(std::wstring_view(L"x a b c"), tokens), 4U);
+  EXPECT_EQ(tokens[1].value, L"a");
+}
+
+// random argument vectors escaped by EscapeArgv split back into the same arguments
+TEST(SplitArgvTest, EscapeRoundTrip) {
+  static constexpr wchar_t alphabet[] = {L'a', L'b', L' ', L'\t', L'"', L'\\', L'\\', L'z'};
+  std::mt19937 rng(20240901);
+  std::uniform_int_distribution<size_t> pick(0, std::size(alphabet) - 1);
+  std::uniform_int_distribution<size_t> length(0, 12);
+  std::uniform_int_distribution<size_t> count(0, 6);
+  for (int round = 0; round < 20000; round++) {
+    args_t args{LR"(C:\Program Files\x.exe)"};
+    for (auto n = count(rng); n > 0; n--) {
+      std::wstring a(length(rng), L'a');
+      for (auto &c : a) {
+        c = alphabet[pick(rng)];
+      }
+      args.emplace_back(std::move(a));
+    }
+    bela::EscapeArgv ea;
+    for (const auto &a : args) {
+      ea.Append(a);
+    }
+    ASSERT_EQ(split(ea.sv()), args) << round;
+  }
+}
+
+} // namespace
@@ -0,0 +1,101 @@
+/// storage_pool recycling, and threads churning blocks through a small pool
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <winmenu/storage_pool.hpp>
+
+namespace winmenu {
+namespace {
+
+struct alignas(32) block {
+  uint64_t owner;
+  uint64_t serial;
+  char payload[48];
+};
+
+TEST(StoragePoolTest, RecyclesReleasedBlocks) {
+  storage_pool<block, 2> pool;
+  bool recycled = true;
+  auto a = pool.allocate(&recycled);
+  ASSERT_NE(a, nullptr);
+  EXPECT_FALSE(recycled);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % alignof(block), 0U);
+  pool.deallocate(a);
+  EXPECT_EQ(pool.snapshot().cached, 1U);
+  auto b = pool.allocate(&recycled);
+  EXPECT_TRUE(recycled);
+  EXPECT_EQ(a, b);
+  pool.deallocate(b);
+  auto st = pool.snapshot();
+  EXPECT_EQ(st.heap, 1U);
+  EXPECT_EQ(st.recycled, 1U);
+  EXPECT_DOUBLE_EQ(st.recycle_rate(), 0.5);
+}
+
+TEST(StoragePoolTest, DropsWhenSlotsAreTaken) {
+  storage_pool<block, 2> pool;
+  void *blocks[3];
+  for (auto &p : blocks) {
+    p = pool.allocate();
+    ASSERT_NE(p, nullptr);
+  }
+  for (auto p : blocks) {
+    pool.deallocate(p);
+  }
+  auto st = pool.snapshot();
+  EXPECT_EQ(st.heap, 3U);
+  EXPECT_EQ(st.dropped, 1U);
+  EXPECT_EQ(st.cached, 2U);
+  pool.deallocate(nullptr);
+  EXPECT_EQ(pool.snapshot().dropped, 1U);
+}
+
+// more threads than slots take, stamp and release blocks: a block is never handed to two holders at once and every
+// allocation is accounted for as heap or recycled
+TEST(StoragePoolStressTest, ConcurrentChurn) {
+  constexpr size_t threads = 8;
+  constexpr uint64_t iterations = 20000;
+  storage_pool<block, 4> pool;
+  std::atomic<size_t> torn{0};
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      void *held[3]{};
+      for (uint64_t i = 0; i < iterations; i++) {
+        auto &slot = held[i % 3];
+        if (slot != nullptr) {
+          auto b = static_cast<block *>(slot);
+          if (b->owner != t || b->serial != i - 3) {
+            torn++;
+          }
+          b->~block();
+          pool.deallocate(slot);
+        }
+        slot = pool.allocate();
+        if (slot == nullptr) {
+          torn++;
+          continue;
+        }
+        new (slot) block{t, i, {}};
+      }
+      for (auto p : held) {
+        if (p != nullptr) {
+          pool.deallocate(p);
+        }
+      }
+    });
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  EXPECT_EQ(torn.load(), 0U);
+  auto st = pool.snapshot();
+  EXPECT_EQ(st.heap + st.recycled, threads * iterations);
+  EXPECT_EQ(st.cached, 4U);
+  EXPECT_EQ(st.heap, st.dropped + st.cached);
+}
+
+} // namespace
+} // namespace winmenu
@@ -0,0 +1,159 @@
+/// trace ring files written, wrapped, continued and summarized
+#include <atomic>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <winmenu/metrics.hpp>
+#include <winmenu/trace.hpp>
+
+namespace winmenu {
+namespace {
+
+using namespace std::chrono_literals;
+
+class TraceRingTest : public testing::Test {
+protected:
+  void SetUp() override {
+    auto info = testing::UnitTest::GetInstance()->current_test_info();
+    path = std::filesystem::temp_directory_path() / (std::string("winmenu-") + info->name() + ".ring");
+    std::filesystem::remove(path);
+  }
+  void TearDown() override { std::filesystem::remove(path); }
+  static trace_record counter(uint32_t value) {
+    return trace_record{value, 0, trace_kind::counter, static_cast<uint16_t>(trace_counter::cache_hit), value};
+  }
+  std::vector<uint32_t> values() {
+    std::vector<trace_record> records;
+    EXPECT_TRUE(read_trace_ring(path, records));
+    std::vector<uint32_t> v;
+    for (const auto &r : records) {
+      v.push_back(r.value);
+    }
+    return v;
+  }
+  std::filesystem::path path;
+};
+
+TEST_F(TraceRingTest, ReadsBackInOrder) {
+  {
+    ring_file_sink sink(path, 8);
+    ASSERT_TRUE(sink.is_open());
+    EXPECT_TRUE(values().empty());
+    for (uint32_t i = 1; i <= 3; i++) {
+      sink.record(counter(i));
+    }
+    // records are flushed as they come, a reader sees them while the sink is open
+    EXPECT_EQ(values(), (std::vector<uint32_t>{1, 2, 3}));
+  }
+  EXPECT_EQ(values(), (std::vector<uint32_t>{1, 2, 3}));
+}
+
+TEST_F(TraceRingTest, KeepsTheLastCapacityRecords) {
+  ring_file_sink sink(path, 4);
+  for (uint32_t i = 0; i < 4; i++) {
+    sink.record(counter(i));
+  }
+  EXPECT_EQ(values(), (std::vector<uint32_t>{0, 1, 2, 3}));
+  for (uint32_t i = 4; i < 10; i++) {
+    sink.record(counter(i));
+  }
+  EXPECT_EQ(values(), (std::vector<uint32_t>{6, 7, 8, 9}));
+  for (uint32_t i = 10; i < 12; i++) {
+    sink.record(counter(i));
+  }
+  EXPECT_EQ(values(), (std::vector<uint32_t>{8, 9, 10, 11}));
+}
+
+// a ring with the same layout is continued, another capacity starts a new one
+TEST_F(TraceRingTest, ReopenContinues) {
+  {
+    ring_file_sink sink(path, 4);
+    for (uint32_t i = 0; i < 3; i++) {
+      sink.record(counter(i));
+    }
+  }
+  {
+    ring_file_sink sink(path, 4);
+    sink.record(counter(3));
+    sink.record(counter(4));
+  }
+  EXPECT_EQ(values(), (std::vector<uint32_t>{1, 2, 3, 4}));
+  {
+    ring_file_sink sink(path, 16);
+    sink.record(counter(5));
+  }
+  EXPECT_EQ(values(), (std::vector<uint32_t>{5}));
+}
+
+TEST_F(TraceRingTest, RejectsOtherFiles) {
+  std::vector<trace_record> records;
+  EXPECT_FALSE(read_trace_ring(path, records));
+  if (auto fd = std::fopen(path.string().c_str(), "wb"); fd != nullptr) {
+    std::fputs("not a trace ring, but long enough to hold a header", fd);
+    std::fclose(fd);
+  }
+  EXPECT_FALSE(read_trace_ring(path, records));
+}
+
+TEST_F(TraceRingTest, TracerForwardsToSinks) {
+  tracer t;
+  auto sink = std::make_shared<ring_file_sink>(path, 16);
+  t.add_sink(sink);
+  { auto scope = t.time(trace_callback::invoke); }
+  t.count(trace_counter::launch_succeeded, 2);
+  t.clear_sinks();
+  t.count(trace_counter::launch_succeeded);
+  std::vector<trace_record> records;
+  ASSERT_TRUE(read_trace_ring(path, records));
+  ASSERT_EQ(records.size(), 2U);
+  EXPECT_EQ(records[0].kind, trace_kind::callback);
+  EXPECT_EQ(records[0].id, static_cast<uint16_t>(trace_callback::invoke));
+  EXPECT_EQ(records[1].kind, trace_kind::counter);
+  EXPECT_EQ(records[1].value, 2U);
+}
+
+// a removed sink gets nothing more, the others keep receiving events
+TEST(TracerTest, RemoveSink) {
+  class counting_sink final : public trace_sink {
+  public:
+    void record(const trace_record &) override { records++; }
+    std::atomic<size_t> records{0};
+  };
+  tracer t;
+  auto a = std::make_shared<counting_sink>();
+  auto b = std::make_shared<counting_sink>();
+  t.add_sink(a);
+  t.add_sink(b);
+  t.count(trace_counter::cache_hit);
+  t.remove_sink(a.get());
+  t.count(trace_counter::cache_hit);
+  EXPECT_EQ(a->records.load(), 1U);
+  EXPECT_EQ(b->records.load(), 2U);
+  t.remove_sink(b.get());
+  t.count(trace_counter::cache_hit);
+  EXPECT_EQ(b->records.load(), 2U);
+  EXPECT_EQ(t.stats().counter(trace_counter::cache_hit), 3U);
+}
+
+TEST(TraceSummaryTest, LatenciesAndCounters) {
+  std::vector<trace_record> records;
+  for (uint64_t i = 1; i <= 100; i++) {
+    records.push_back({i, i * 1000, trace_kind::callback, static_cast<uint16_t>(trace_callback::get_state), 0});
+  }
+  records.push_back({0, 0, trace_kind::counter, static_cast<uint16_t>(trace_counter::registry_read), 3});
+  records.push_back({0, 0, trace_kind::counter, static_cast<uint16_t>(trace_counter::registry_read), 4});
+  // records of a newer build are skipped
+  records.push_back({0, 0, trace_kind::counter, 0xffff, 1});
+  records.push_back({0, 5, trace_kind::callback, 0xffff, 0});
+  auto summary = summarize_trace(records);
+  const auto &l = summary.callbacks[static_cast<size_t>(trace_callback::get_state)];
+  EXPECT_EQ(l.calls, 100U);
+  EXPECT_EQ(l.total, 5050U * 1000);
+  EXPECT_EQ(l.p50, 50U * 1000);
+  EXPECT_EQ(l.p99, 99U * 1000);
+  EXPECT_EQ(l.max, 100U * 1000);
+  EXPECT_EQ(summary.callbacks[static_cast<size_t>(trace_callback::invoke)].calls, 0U);
+  EXPECT_EQ(summary.counters[static_cast<size_t>(trace_counter::registry_read)], 7U);
+}
+
+} // namespace
+} // namespace winmenu
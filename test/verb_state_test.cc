@@ -0,0 +1,96 @@
+/// verb_state_machine driven by a fake clock and counting probes
+#include <gtest/gtest.h>
+#include <winmenu/verb_state.hpp>
+
+namespace winmenu {
+namespace {
+
+using namespace std::chrono_literals;
+
+class counting_probe final : public state_probe {
+public:
+  std::optional<bool> installed_cached() override { return cached; }
+  bool installed() override {
+    installed_calls++;
+    return isInstalled;
+  }
+  std::optional<selection_facts> selection() override {
+    selection_calls++;
+    return facts;
+  }
+  void hold() override { holds++; }
+  std::optional<bool> cached;
+  bool isInstalled{true};
+  std::optional<selection_facts> facts{selection_facts{1, true, false, false, false}};
+  size_t installed_calls{0};
+  size_t selection_calls{0};
+  size_t holds{0};
+};
+
+class VerbStateTest : public testing::Test {
+protected:
+  verb_state query(const void *key, bool okToBeSlow) { return machine.query(key, okToBeSlow, probe, now); }
+  verb_state_machine machine{2s};
+  counting_probe probe;
+  verb_state_machine::clock::time_point now{};
+  int a{0};
+  int b{0};
+};
+
+TEST_F(VerbStateTest, MissingInstallationHidesAtOnce) {
+  probe.cached = false;
+  EXPECT_EQ(query(&a, false), verb_state::hidden);
+  EXPECT_EQ(probe.installed_calls + probe.selection_calls, 0U);
+}
+
+TEST_F(VerbStateTest, PendingUntilSlowCall) {
+  EXPECT_EQ(query(&a, false), verb_state::pending);
+  EXPECT_EQ(probe.selection_calls, 0U);
+  EXPECT_EQ(query(&a, true), verb_state::enabled);
+  EXPECT_EQ(probe.selection_calls, 1U);
+  EXPECT_EQ(probe.holds, 1U);
+  // the decision is repeated for the same selection without probing
+  now += 1s;
+  EXPECT_EQ(query(&a, false), verb_state::enabled);
+  EXPECT_EQ(query(&a, true), verb_state::enabled);
+  EXPECT_EQ(probe.selection_calls, 1U);
+}
+
+TEST_F(VerbStateTest, DecisionExpires) {
+  EXPECT_EQ(query(&a, true), verb_state::enabled);
+  now += 2s;
+  EXPECT_EQ(query(&a, false), verb_state::pending);
+  EXPECT_EQ(query(&a, true), verb_state::enabled);
+  EXPECT_EQ(probe.selection_calls, 2U);
+  // the same selection decided again is already held
+  EXPECT_EQ(probe.holds, 1U);
+}
+
+// a decision is only repeated for the selection it was made for, the new one is held instead
+TEST_F(VerbStateTest, NewSelectionIsDecidedAndHeld) {
+  EXPECT_EQ(query(&a, true), verb_state::enabled);
+  EXPECT_EQ(query(&b, false), verb_state::pending);
+  probe.facts = std::nullopt;
+  EXPECT_EQ(query(&b, true), verb_state::hidden);
+  EXPECT_EQ(probe.holds, 2U);
+  EXPECT_EQ(query(&b, false), verb_state::hidden);
+}
+
+TEST_F(VerbStateTest, ResetForgetsDecision) {
+  EXPECT_EQ(query(&a, true), verb_state::enabled);
+  machine.reset();
+  EXPECT_EQ(query(&a, false), verb_state::pending);
+  EXPECT_EQ(query(&a, true), verb_state::enabled);
+  EXPECT_EQ(probe.holds, 2U);
+}
+
+TEST_F(VerbStateTest, NotInstalledAfterResolving) {
+  probe.isInstalled = false;
+  EXPECT_EQ(query(&a, true), verb_state::hidden);
+  EXPECT_EQ(probe.selection_calls, 0U);
+  probe.cached = false;
+  EXPECT_EQ(query(&a, false), verb_state::hidden);
+}
+
+} // namespace
+} // namespace winmenu
@@ -0,0 +1,93 @@
+/// winmenu-trace summarizes the ring files written when WINMENU_TRACE_DIR is set, and on Windows the live metrics of
+/// an extension
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <winmenu/trace.hpp>
+#include <winmenu/metrics.hpp>
+#if defined(_WIN32)
+#include <winmenu/win32.hpp>
+#endif
+
+namespace {
+void print_counters(const char *name, unsigned long long value) { std::printf("%-18s %8llu\n", name, value); }
+
+int summarize_rings(int argc, char **argv) {
+  std::vector<winmenu::trace_record> records;
+  std::vector<winmenu::trace_record> all;
+  for (int i = 1; i < argc; i++) {
+    if (!winmenu::read_trace_ring(argv[i], records)) {
+      std::fprintf(stderr, "%s: not a WinMenu trace ring\n", argv[i]);
+      return 1;
+    }
+    all.insert(all.end(), records.begin(), records.end());
+  }
+  auto summary = winmenu::summarize_trace(all);
+  std::printf("%-18s %8s %12s %12s %12s %12s\n", "callback", "calls", "mean(us)", "p50(us)", "p99(us)", "max(us)");
+  for (size_t i = 0; i < summary.callbacks.size(); i++) {
+    const auto &l = summary.callbacks[i];
+    if (l.calls == 0) {
+      continue;
+    }
+    std::printf("%-18s %8llu %12.1f %12.1f %12.1f %12.1f\n",
+                winmenu::trace_callback_name(static_cast<winmenu::trace_callback>(i)),
+                static_cast<unsigned long long>(l.calls), static_cast<double>(l.total) / l.calls / 1000.0,
+                l.p50 / 1000.0, l.p99 / 1000.0, l.max / 1000.0);
+  }
+  for (size_t i = 0; i < summary.counters.size(); i++) {
+    print_counters(winmenu::trace_counter_name(static_cast<winmenu::trace_counter>(i)),
+                   static_cast<unsigned long long>(summary.counters[i]));
+  }
+  return 0;
+}
+
+#if defined(_WIN32)
+int scrape_metrics(const char *tag, const char *pid) {
+  std::wstring wtag(tag, tag + std::strlen(tag));
+  auto block = winmenu::win32::open_metrics_block(
+      winmenu::win32::metrics_mapping_name(wtag, static_cast<DWORD>(std::strtoul(pid, nullptr, 10))));
+  if (block == nullptr) {
+    std::fprintf(stderr, "no WinMenu metrics for %s in process %s\n", tag, pid);
+    return 1;
+  }
+  std::printf("%-18s %8s %12s %12s %12s\n", "callback", "calls", "mean(us)", "p50(us)", "p99(us)");
+  for (size_t i = 0; i < winmenu::metric_callbacks; i++) {
+    auto c = static_cast<winmenu::trace_callback>(i);
+    auto l = winmenu::read_latency(*block, c);
+    if (l.calls == 0) {
+      continue;
+    }
+    std::printf("%-18s %8llu %12.1f %12llu %12llu\n", winmenu::trace_callback_name(c),
+                static_cast<unsigned long long>(l.calls), static_cast<double>(l.sum) / l.calls,
+                static_cast<unsigned long long>(l.percentile(50)), static_cast<unsigned long long>(l.percentile(99)));
+  }
+  for (size_t i = 0; i < winmenu::metric_counters; i++) {
+    auto c = static_cast<winmenu::trace_counter>(i);
+    print_counters(winmenu::trace_counter_name(c), static_cast<unsigned long long>(winmenu::read_counter(*block, c)));
+  }
+  return 0;
+}
+#endif
+} // namespace
+
+int main(int argc, char **argv) {
+#if defined(_WIN32)
+  // the shell extension publishes its metrics under the tag winmenu
+  if (argc == 3 && std::strcmp(argv[1], "--metrics") == 0) {
+    return scrape_metrics("winmenu", argv[2]);
+  }
+  if (argc == 4 && std::strcmp(argv[1], "--metrics") == 0) {
+    return scrape_metrics(argv[2], argv[3]);
+  }
+#endif
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s winmenu-<tag>-<pid>.trace...\n", argv[0]);
+#if defined(_WIN32)
+    std::fprintf(stderr, "       %s --metrics [<tag>] <pid>    (tag defaults to winmenu)\n", argv[0]);
+#endif
+    return 1;
+  }
+  return summarize_rings(argc, argv);
+}